@@ -0,0 +1,226 @@
+// Headless benchmark runner: steps a World without opening a window and reports throughput
+// Built by CMakeLists.txt (target R2INTBench) rather than R2INT.sln, since it has its own main()
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include "OffsetStruct.h"
+#include "R2INT_File.h"
+#include "RuleCompiler.h"
+#include "ThreadPool.h"
+#include "World.h"
+
+// Times every chunk looks up its 8 neighbors in the --lookups neighbor query pass
+#define BENCH_NEIGHBOR_PASSES 100
+
+#ifdef _WIN32
+#include <windows.h>
+#include <psapi.h>
+#pragma comment(lib, "psapi.lib")
+#else
+#include <sys/resource.h>
+#endif
+
+// Peak resident memory of this process in bytes, 0 if unknown
+static uint64_t PeakMemoryBytes()
+{
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+        return counters.PeakWorkingSetSize;
+    return 0;
+#else
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0)
+        return 0;
+#ifdef __APPLE__
+    return static_cast<uint64_t>(usage.ru_maxrss);        // Bytes on macOS
+#else
+    return static_cast<uint64_t>(usage.ru_maxrss) * 1024; // Kilobytes on Linux
+#endif
+#endif
+}
+
+static void PrintUsage()
+{
+    std::cout << "Usage: R2INTBench [options]\n"
+        << "  --rule FILE       .r2int or .r2bin rule to run\n"
+        << "  --rulestring R    Rulestring to run instead, e.g. B3/S23 or R2,C2,S6-9,B7-8,NM (default: B3/S23)\n"
+        << "  --pattern FILE    RLE pattern to start from\n"
+        << "  --seed N          Seed for a 64x64 random soup (default: 1; ignored with --pattern)\n"
+        << "  --gens N          Generations to run (default: 1000)\n"
+        << "  --threads N       Worker threads, 0 = all hardware threads (default: 0)\n"
+        << "  --hashlife K      Use the HashLife engine, jumping 2^K generations per step\n"
+        << "  --print           Print the final pattern as RLE\n"
+        << "  --lookups         Also time chunk lookups: RLE export (one lookup per cell) and neighbor queries\n";
+}
+
+int main(int argc, char* argv[])
+{
+    std::string rulePath;
+    std::string rulestring = "B3/S23";
+    std::string patternPath;
+    unsigned int seed = 1;
+    int64_t generations = 1000;
+    int threadCount = 0;
+    int hashLifeStep = -1;
+    bool printResult = false;
+    bool benchLookups = false;
+
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+
+        if (arg == "--rule" && hasValue)
+            rulePath = argv[++i];
+        else if (arg == "--rulestring" && hasValue)
+            rulestring = argv[++i];
+        else if (arg == "--pattern" && hasValue)
+            patternPath = argv[++i];
+        else if (arg == "--seed" && hasValue)
+            seed = static_cast<unsigned int>(std::strtoul(argv[++i], nullptr, 10));
+        else if (arg == "--gens" && hasValue)
+            generations = std::strtoll(argv[++i], nullptr, 10);
+        else if (arg == "--threads" && hasValue)
+            threadCount = std::atoi(argv[++i]);
+        else if (arg == "--hashlife" && hasValue)
+            hashLifeStep = std::atoi(argv[++i]);
+        else if (arg == "--print")
+            printResult = true;
+        else if (arg == "--lookups")
+            benchLookups = true;
+        else
+        {
+            PrintUsage();
+            return arg == "--help" || arg == "-h" ? 0 : 1;
+        }
+    }
+
+    if (generations < 0 || hashLifeStep > 40)
+    {
+        PrintUsage();
+        return 1;
+    }
+
+    R2INTRules rules;
+    if (rulePath.empty())
+    {
+        if (!CompileRulestring(rulestring, rules, threadCount))
+            return 1;
+    }
+    else if (!LoadRuleFile(rules, rulePath))
+        return 1;
+
+    World world;
+    world.ThreadCount = threadCount;
+    if (hashLifeStep >= 0)
+    {
+        world.Engine = ENGINE_HASHLIFE;
+        world.HashLifeStep = hashLifeStep;
+    }
+
+    if (!patternPath.empty())
+    {
+        if (!world.LoadRLE(patternPath))
+            return 1;
+    }
+    else
+    {
+        world.rng.seed(seed);
+        world.TestRandomize();
+    }
+
+    // Chunk engine: one generation per step; HashLife: 2^K generations per step, rounded up
+    // (B0 rules can't jump, so under HashLife they still step one generation at a time)
+    int64_t stepSize = hashLifeStep >= 0 ? int64_t(1) << hashLifeStep : 1;
+    int64_t target = (generations + stepSize - 1) / stepSize * stepSize;
+
+    int64_t cellUpdates = 0;
+    bool steppedChunks = false; // HashLife still steps chunks for the rules it can't jump
+    size_t peakChunks = world.contents.Size();
+
+    auto start = std::chrono::steady_clock::now();
+    while (world.Generation < target)
+    {
+        bool stepsChunks = world.Engine == ENGINE_CHUNKS || !world.CanJump(rules);
+        world.Simulate(rules);
+
+        steppedChunks |= stepsChunks;
+        if (stepsChunks)
+            cellUpdates += static_cast<int64_t>(world.ActiveChunks) * GRID_DIMENSIONS * GRID_DIMENSIONS;
+        peakChunks = std::max(peakChunks, world.contents.Size());
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    if (printResult)
+        world.PrintRLE();
+
+    double perSecond = seconds > 0 ? 1.0 / seconds : 0.0;
+    std::cout << "Generations:         " << world.Generation << "\n"
+        << "Population:          " << world.Population() << "\n"
+        << "Time:                " << seconds << " s\n"
+        << "Generations/sec:     " << world.Generation * perSecond << "\n";
+    if (steppedChunks)
+        std::cout << "Cell updates/sec:    " << cellUpdates * perSecond << "\n";
+    else
+        std::cout << "Cell updates/sec:    n/a (HashLife)\n";
+    // The rule is only analyzed when chunks step, which HashLife still does for the B0 rules it can't jump
+    if (world.Engine != ENGINE_CHUNKS && !world.AnalyzedRule)
+        std::cout << "Kernel:              n/a (HashLife)\n";
+    else if (world.Totalistic.Range)
+        std::cout << "Kernel:              outer-totalistic, range " << world.Totalistic.Range << "\n";
+    else if (world.Shaped)
+        std::cout << "Kernel:              " << (world.Shaped->Shape == SHAPE_DIAMOND ? "diamond" : "octagon") << " table\n";
+    else
+        std::cout << "Kernel:              transition table\n";
+    std::cout << "Chunks (final/peak): " << world.contents.Size() << " / " << peakChunks << "\n"
+        << "Chunk pool:          " << world.contents.PoolCapacity() << " slots\n"
+        << "Threads:             " << ThreadPool::ResolveThreadCount(threadCount) << "\n"
+        << "Peak memory:         " << PeakMemoryBytes() / (1024.0 * 1024.0) << " MB" << std::endl;
+
+    if (benchLookups)
+    {
+        auto rectStart = std::chrono::steady_clock::now();
+        sf::IntRect rect = world.GetRect();
+        double rectSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - rectStart).count();
+
+        // RLE export reads the bounding box cell by cell through GetCellStateAt, a chunk lookup each
+        int64_t cells = rect.size.x > 0 && rect.size.y > 0 ? static_cast<int64_t>(rect.size.x) * rect.size.y : 0;
+        auto exportStart = std::chrono::steady_clock::now();
+        size_t rleLength = world.ToRLE().size();
+        double exportSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - exportStart).count();
+
+        // Neighbor queries, as linking and drawing make them
+        int64_t queries = 0;
+        int64_t found = 0;
+        auto queryStart = std::chrono::steady_clock::now();
+        for (int pass = 0; pass < BENCH_NEIGHBOR_PASSES; pass++)
+        {
+            for (const Chunk& chunk : world.contents)
+            {
+                for (int dy = -1; dy <= 1; dy++)
+                {
+                    for (int dx = -1; dx <= 1; dx++)
+                    {
+                        if (dx == 0 && dy == 0)
+                            continue;
+                        found += world.contents.Find({ chunk.CoordinateX + dx, chunk.CoordinateY + dy }) != nullptr;
+                        queries++;
+                    }
+                }
+            }
+        }
+        double querySeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - queryStart).count();
+
+        std::cout << "Bounding box:        " << rect.size.x << " x " << rect.size.y << " in " << rectSeconds * 1e6 << " us\n"
+            << "RLE export:          " << exportSeconds * 1000.0 << " ms, " << rleLength << " chars, "
+            << (exportSeconds > 0 ? cells / exportSeconds : 0.0) << " cells/sec\n"
+            << "Neighbor queries:    " << (querySeconds > 0 ? queries / querySeconds : 0.0) << " /sec ("
+            << found * 100.0 / std::max<int64_t>(queries, 1) << "% hits)" << std::endl;
+    }
+
+    return 0;
+}
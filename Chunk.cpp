@@ -1,6 +1,7 @@
 #include "Chunk.h"
 #include "World.h"
-#include "Debug.h"
+#include "BitOps.h"
+#include <algorithm>
 #include <vector>
 #include <random>
 #include <iostream>
@@ -10,13 +11,10 @@ Chunk::Chunk() {
     CoordinateX = 0;
     CoordinateY = 0;
     Fill = 0;
+    PreviousFill = 0;
     
-    for (int y = 0; y < GRID_DIMENSIONS; ++y) {
-        for (int x = 0; x < GRID_DIMENSIONS; ++x) {
-            Grid[x][y] = 0;
-            OldGrid[x][y] = 0;
-        }
-    }
+    Buffers[0].fill(0);
+    Buffers[1].fill(0);
 
     for (int i = 0; i < 3; ++i)
     {
@@ -34,13 +32,10 @@ Chunk::Chunk(int x, int y) {
     CoordinateX = x;
     CoordinateY = y;
     Fill = 0;
+    PreviousFill = 0;
 
-    for (int y = 0; y < GRID_DIMENSIONS; ++y) {
-        for (int x = 0; x < GRID_DIMENSIONS; ++x) {
-            Grid[x][y] = 0;
-            OldGrid[x][y] = 0;
-        }
-    }
+    Buffers[0].fill(0);
+    Buffers[1].fill(0);
 
     for (int i = 0; i < 3; ++i)
     {
@@ -53,113 +48,193 @@ Chunk::Chunk(int x, int y) {
     neighborGrids[1][1] = this;
 }
 
-void Chunk::FillWithVoidState(char voidState)
+// Mask in the ChangedMask layout for a set of cells, given as the columns they occupy in the whole chunk (any)
+// and in its first and last 2 rows: bit (dx, dy) when one is within 2 cells of that neighbor, the center bit when any is set
+static uint16_t BandMask(uint64_t any, uint64_t north, uint64_t south)
 {
-    for (int y = 0; y < GRID_DIMENSIONS; ++y) {
-        for (int x = 0; x < GRID_DIMENSIONS; ++x) {
-            Grid[x][y] = voidState;
-            OldGrid[x][y] = voidState;
-        }
+    const uint64_t westColumns = CellMask(0) | CellMask(1);
+    const uint64_t eastColumns = CellMask(GRID_DIMENSIONS - 2) | CellMask(GRID_DIMENSIONS - 1);
+
+    uint16_t mask = 0;
+    if (any) mask |= CHUNK_CHANGED_SELF;
+    if (north) mask |= ChangedBit(0, -1);
+    if (south) mask |= ChangedBit(0, 1);
+    if (any & westColumns) mask |= ChangedBit(-1, 0);
+    if (any & eastColumns) mask |= ChangedBit(1, 0);
+    if (north & westColumns) mask |= ChangedBit(-1, -1);
+    if (north & eastColumns) mask |= ChangedBit(1, -1);
+    if (south & westColumns) mask |= ChangedBit(-1, 1);
+    if (south & eastColumns) mask |= ChangedBit(1, 1);
+    return mask;
+}
+
+// Summaries of two buffers that are all alive or all dead
+static void SetUniformSummaries(Chunk& chunk, bool alive)
+{
+    for (int b = 0; b < 2; b++)
+    {
+        chunk.LiveBorder[b] = alive ? CHUNK_CHANGED_ALL : 0;
+        chunk.DeadBorder[b] = alive ? 0 : CHUNK_CHANGED_ALL;
+        chunk.LiveColumns[b] = alive ? ~uint64_t(0) : 0;
+        chunk.TopRow[b] = alive ? 0 : GRID_DIMENSIONS;
+        chunk.BottomRow[b] = alive ? GRID_DIMENSIONS - 1 : -1;
     }
+}
+
+void Chunk::FillWithVoidState(char voidState)
+{
+    uint64_t row = voidState ? ~uint64_t(0) : 0;
+    Buffers[0].fill(row);
+    Buffers[1].fill(row);
     Fill = GRID_DIMENSIONS * GRID_DIMENSIONS * voidState; // Fill is the total number of filled cells
+    PreviousFill = Fill;
+    SetUniformSummaries(*this, voidState != 0);
 }
 
-__int8 Chunk::GetCellStateAt(sf::Vector2i localXY) const
+void Chunk::SetCell(int x, int y, int8_t state)
 {
-    return OldGrid[localXY.x][localXY.y];
+    ChangedMask = CHUNK_CHANGED_ALL;
+
+    uint64_t cell = CellMask(x);
+    if (state) {
+        uint16_t border = BandMask(cell, y < 2 ? cell : 0, y >= GRID_DIMENSIONS - 2 ? cell : 0);
+        for (int b = 0; b < 2; b++) {
+            Buffers[b][y] |= cell;
+            LiveBorder[b] |= border;
+            LiveColumns[b] |= cell;
+            TopRow[b] = static_cast<int8_t>(std::min<int>(TopRow[b], y));
+            BottomRow[b] = static_cast<int8_t>(std::max<int>(BottomRow[b], y));
+        }
+    }
+    else {
+        Buffers[0][y] &= ~cell;
+        Buffers[1][y] &= ~cell;
+
+        // Erasing can only shrink the bounds or clear border bits when the cell sits on one of them, so only then rescan
+        // (an emptied inner column may stay set in LiveColumns, which is only read at its edges)
+        bool onBorder = y < 2 || y >= GRID_DIMENSIONS - 2 || x < 2 || x >= GRID_DIMENSIONS - 2;
+        for (int b = 0; b < 2 && !onBorder; b++) {
+            uint64_t columns = LiveColumns[b];
+            onBorder = columns && (y == TopRow[b] || y == BottomRow[b] ||
+                x == CountLeadingZeros64(columns) || x == GRID_DIMENSIONS - 1 - CountTrailingZeros64(columns));
+        }
+
+        if (onBorder) {
+            UpdateSummaries();
+        }
+        else {
+            DeadBorder[0] |= CHUNK_CHANGED_SELF;
+            DeadBorder[1] |= CHUNK_CHANGED_SELF;
+        }
+    }
 }
 
 void Chunk::Clear()
 {
-    for (int x = 0; x < GRID_DIMENSIONS; x++) {
-        for (int y = 0; y < GRID_DIMENSIONS; y++) {
+    Buffers[0].fill(0);
+    Buffers[1].fill(0);
+    Fill = 0;
+    PreviousFill = 0;
+    ChangedMask = CHUNK_CHANGED_ALL;
+    SetUniformSummaries(*this, false);
+}
 
-            Grid[x][y] = 0;
-            OldGrid[x][y] = 0;
+void Chunk::UpdateSummaries()
+{
+    for (int b = 0; b < 2; b++)
+    {
+        const ChunkRows& rows = Buffers[b];
+        uint64_t anyLive = 0;
+        uint64_t allLive = ~uint64_t(0);
+        int top = GRID_DIMENSIONS;
+        int bottom = -1;
+        for (int y = 0; y < GRID_DIMENSIONS; y++)
+        {
+            anyLive |= rows[y];
+            allLive &= rows[y];
+            if (rows[y])
+            {
+                top = std::min(top, y);
+                bottom = y;
+            }
         }
+        LiveColumns[b] = anyLive;
+        TopRow[b] = static_cast<int8_t>(top);
+        BottomRow[b] = static_cast<int8_t>(bottom);
+
+        uint64_t northLive = rows[0] | rows[1];
+        uint64_t southLive = rows[GRID_DIMENSIONS - 2] | rows[GRID_DIMENSIONS - 1];
+        uint64_t northDead = ~(rows[0] & rows[1]);
+        uint64_t southDead = ~(rows[GRID_DIMENSIONS - 2] & rows[GRID_DIMENSIONS - 1]);
+        LiveBorder[b] = BandMask(anyLive, northLive, southLive);
+        DeadBorder[b] = BandMask(~allLive, northDead, southDead);
     }
 }
 
 void Chunk::RandomizeRect(sf::Rect<int> RandomizedSection, bool Delete, std::mt19937& gen) {
     static std::uniform_int_distribution<int> number_distribution(0, 100);
 
+    // Cells to overwrite and the ones among them that become alive, gathered first and written a row at a time
+    ChunkRows overwritten{};
+    ChunkRows alive{};
+
     for (int x = 0; x < GRID_DIMENSIONS; x++) {
         for (int y = 0; y < GRID_DIMENSIONS; y++) {
             sf::Vector2i cellPoint(x, y);  // Equivalent to POINT {x, y}
 
             // Check if the point is within the randomized section
             if (!RandomizedSection.contains(cellPoint)) {
-                if (Delete) {
-                    Grid[x][y] = 0;
-                    OldGrid[x][y] = 0;
-                }
+                if (Delete)
+                    overwritten[y] |= CellMask(x);
 
                 continue;
             }
 
             int n = number_distribution(gen);
-            Grid[x][y] = n / 51; // Bugged for higher Fill percentages
-            OldGrid[x][y] = Grid[x][y];
+            overwritten[y] |= CellMask(x);
+            if (n / 51) // Bugged for higher Fill percentages
+                alive[y] |= CellMask(x);
         }
     }
-}
 
-// Synchronize the old grid with the current grid
-void Chunk::ResetOld()
-{
-    OldGrid = Grid;
+    for (int b = 0; b < 2; b++) {
+        for (int y = 0; y < GRID_DIMENSIONS; y++)
+            Buffers[b][y] = (Buffers[b][y] & ~overwritten[y]) | alive[y];
+    }
+
+    Fill = 0;
+    for (uint64_t row : Buffers[0])
+        Fill += PopCount64(row);
+    PreviousFill = Fill;
+    ChangedMask = CHUNK_CHANGED_ALL;
+    UpdateSummaries();
 }
 
 void EnsureNeighborsExist(World& world, Chunk& grid) {
     grid.EnsureNeighborsExist(world);
 }
 
-// --- 1) Change signature of NeedsNeighbors to accept the void state ---
-bool Chunk::NeedsNeighbors(__int8 voidState) const {
-    // Check if any cell of the previous-generation (OldGrid) is non-void
-    // and within 2 cells of the edge.
-    for (int y = 0; y < GRID_DIMENSIONS; ++y) {
-        for (int x = 0; x < GRID_DIMENSIONS; ++x) {
-            if (OldGrid[x][y] != voidState &&
-                (x <= 1 || x >= GRID_DIMENSIONS - 2 ||
-                    y <= 1 || y >= GRID_DIMENSIONS - 2)) {
-                return true;
-            }
-        }
-    }
-    return false;
-}
-
 void Chunk::EnsureNeighborsExist(World& world) const
 {
+    // Only neighbors within reach of a non-void cell can change next generation
+    uint16_t border = BorderMask(world.VoidState, world.Parity);
+
     for (int dy = -1; dy <= 1; ++dy) {
         for (int dx = -1; dx <= 1; ++dx) {
             if (dx == 0 && dy == 0) continue; // skip self
 
-            int nx = CoordinateX + dx;
-            int ny = CoordinateY + dy;
-            GridCoord neighborCoord{ nx, ny };
-
-            // Skip if neighbor already exists
-            if (world.contents.find(neighborCoord) != world.contents.end())
+            // Skip if the border facing it is all void, or the neighbor already exists
+            if (!(border & ChangedBit(dx, dy)) || neighborGrids[dx + 1][dy + 1])
                 continue;
 
-            // Check if a neighbor is needed (any non-VoidState cell near that edge)
-            bool shouldCreate = NeedsNeighbors(world.VoidState);
-
-            if (!shouldCreate) continue;
-
             // Create the neighbor grid in the world
-            auto& newGrid = world.contents[neighborCoord];
-            newGrid.CoordinateX = nx;
-            newGrid.CoordinateY = ny;
+            Chunk& newGrid = world.contents.Insert({ CoordinateX + dx, CoordinateY + dy });
 
             // Fill everything with current VoidState (strict infinite background)
             newGrid.FillWithVoidState(world.VoidState);
 
-            // DEBUG log
-            //std::cout << "[DEBUG] Created new chunk at (" << nx << ", " << ny
-            //    << ") with VoidState=" << (int)world.VoidState << std::endl;
+            // It looks exactly like the void it replaces, so only the new chunk itself needs stepping
+            newGrid.ChangedMask = CHUNK_CHANGED_SELF;
         }
     }
 }
@@ -169,116 +244,287 @@ static bool operator!=(const Chunk& lhs, const Chunk& rhs)
     if (lhs.CoordinateX != rhs.CoordinateX) return true;
     if (lhs.CoordinateY != rhs.CoordinateY) return true;
     if (lhs.Fill != rhs.Fill) return true;
-    if (lhs.Grid != rhs.Grid) return true;  // std::array supports operator!= recursively
+    if (lhs.Buffers[0] != rhs.Buffers[0]) return true;  // std::array supports operator!= recursively
+    if (lhs.Buffers[1] != rhs.Buffers[1]) return true;
     return false; // The chunks are equal, so return false
 }
 
-void Chunk::Simulate(const R2INTRules& rules, World& world)
-{
-    __int8 NewVoidState = ApplyRules(world.VoidState == 1 ? 33554431 : 0, rules) ? 1 : 0;
+// Bits of the neighborhood index that survive a one-cell step along x:
+// every 5-bit row window shifts up by one and drops its old dx = -2 cell
+#define ROLL_MASK 0x1EF7BDE
 
-    Fill = 0;
-    std::array<std::array<char, GRID_DIMENSIONS>, GRID_DIMENSIONS> newGrid = {};
+// Copy the previous generation plus a 2-cell border taken from the linked neighbors
+// Missing neighbors are treated as VoidState; neighborGrids is kept linked by ChunkMap
+void Chunk::BuildApron(ChunkApron& apron, int8_t voidState, uint8_t parity) const
+{
+    const uint64_t voidRow = voidState ? ~uint64_t(0) : 0;
+    const uint8_t voidSide = voidState ? 3 : 0;
 
-    for (int y = 0; y < GRID_DIMENSIONS; y++)
+    for (int gy = 0; gy < 3; gy++)
     {
-        for (int x = 0; x < GRID_DIMENSIONS; x++)
+        // Apron rows covered by this band of neighbors, and the source rows they come from
+        int firstRow = gy == 0 ? 0 : gy == 1 ? 2 : GRID_DIMENSIONS + 2;
+        int rowCount = gy == 1 ? GRID_DIMENSIONS : 2;
+        int sourceRow = gy == 0 ? GRID_DIMENSIONS - 2 : 0;
+
+        const Chunk* west = neighborGrids[0][gy];
+        const Chunk* center = neighborGrids[1][gy];
+        const Chunk* east = neighborGrids[2][gy];
+
+        for (int i = 0; i < rowCount; i++)
         {
-            int neighborhoodInt = 0;
-            int weight = 1 << 24;
+            int r = firstRow + i;
+            int src = sourceRow + i;
 
-            for (int dy = -2; dy <= 2; dy++)
-            {
-                for (int dx = -2; dx <= 2; dx++)
-                {
-                    int local_x = x + dx;
-                    int local_y = y + dy;
-                    int state = 0;
-
-                    if (local_x < 0 || local_x >= GRID_DIMENSIONS || local_y < 0 || local_y >= GRID_DIMENSIONS)
-                    {
-                        int global_x = CoordinateX * GRID_DIMENSIONS + local_x;
-                        int global_y = CoordinateY * GRID_DIMENSIONS + local_y;
-
-                        state = world.GetCellStateAtOld({ global_x, global_y });
-                    }
-                    else
-                    {
-                        state = Grid[local_x][local_y];
-                    }
-                    
-
-                    neighborhoodInt += state * weight;
-                    weight >>= 1;
-                }
-            }
+            apron.Rows[r] = center ? center->Buffers[parity][src] : voidRow;
+            apron.Left[r] = west ? static_cast<uint8_t>(west->Buffers[parity][src] & 3) : voidSide;
+            apron.Right[r] = east ? static_cast<uint8_t>(east->Buffers[parity][src] >> (GRID_DIMENSIONS - 2)) : voidSide;
+        }
+    }
+}
 
-            newGrid[x][y] = ApplyRules(neighborhoodInt, rules) ? 1 : 0;
-            Fill += newGrid[x][y];
+// Next generation of every row, one cell at a time: lookup(transition) gives each cell's new state
+// Instantiated once per table layout, so the compacted tables get their own loop with the index gather inlined
+template <typename Lookup>
+static void StepTable(const ChunkApron& apron, const Lookup& lookup, ChunkRows& next)
+{
+    for (int y = 0; y < GRID_DIMENSIONS; y++)
+    {
+        // Apron rows y .. y + 4 hold cell rows y - 2 .. y + 2
+        const uint64_t* rows = &apron.Rows[y];
+        const uint8_t* left = &apron.Left[y];
+        const uint8_t* right = &apron.Right[y];
 
-            // Assume NewVoidState
-            if (newGrid[x][y] != NewVoidState && (x < 2 || x >= GRID_DIMENSIONS - 2 || y < 2 || y >= GRID_DIMENSIONS - 2))
-            {
-                //EnsureNeighborsExist(world);
-            }
+        // The 5 cells of a column, placed at the lowest bit of each row window
+        auto InnerColumn = [rows](int x) -> int
+        {
+            int shift = GRID_DIMENSIONS - 1 - x;
+            return static_cast<int>(((rows[0] >> shift) & 1) << 20 | ((rows[1] >> shift) & 1) << 15 |
+                ((rows[2] >> shift) & 1) << 10 | ((rows[3] >> shift) & 1) << 5 | ((rows[4] >> shift) & 1));
+        };
+        auto SideColumn = [](const uint8_t* side, int bit) -> int
+        {
+            return ((side[0] >> bit) & 1) << 20 | ((side[1] >> bit) & 1) << 15 |
+                ((side[2] >> bit) & 1) << 10 | ((side[3] >> bit) & 1) << 5 | ((side[4] >> bit) & 1);
+        };
+
+        // Prime the window with columns -2 to +1; each step along x only shifts in column x + 2
+        int neighborhoodInt = SideColumn(left, 1);
+        neighborhoodInt = ((neighborhoodInt << 1) & ROLL_MASK) | SideColumn(left, 0);
+        neighborhoodInt = ((neighborhoodInt << 1) & ROLL_MASK) | InnerColumn(0);
+        neighborhoodInt = ((neighborhoodInt << 1) & ROLL_MASK) | InnerColumn(1);
+
+        uint64_t newRow = 0;
+        for (int x = 0; x < GRID_DIMENSIONS - 2; x++)
+        {
+            neighborhoodInt = ((neighborhoodInt << 1) & ROLL_MASK) | InnerColumn(x + 2);
+            newRow = (newRow << 1) | (lookup(neighborhoodInt) ? 1 : 0);
         }
+        for (int bit = 1; bit >= 0; bit--)
+        {
+            neighborhoodInt = ((neighborhoodInt << 1) & ROLL_MASK) | SideColumn(right, bit);
+            newRow = (newRow << 1) | (lookup(neighborhoodInt) ? 1 : 0);
+        }
+        next[y] = newRow;
     }
+}
 
-    Grid = newGrid;
+// Apron row r with every cell replaced by the one dx columns over, pulling the edge cells from Left/Right
+static inline uint64_t ShiftedApronRow(const ChunkApron& apron, int r, int dx)
+{
+    uint64_t row = apron.Rows[r];
+    switch (dx)
+    {
+    case -2: return (row >> 2) | (uint64_t(apron.Left[r]) << 62);
+    case -1: return (row >> 1) | (uint64_t(apron.Left[r] & 1) << 63);
+    case 1:  return (row << 1) | (apron.Right[r] >> 1);
+    case 2:  return (row << 2) | apron.Right[r];
+    default: return row;
+    }
 }
 
-// Components of GetRect
-int Chunk::getTop() const {
-    for (int y = 0; y < GRID_DIMENSIONS; y++) {
-        for (int x = 0; x < GRID_DIMENSIONS; x++) {
-            if (Grid[x][y] != 0) {
-                return y;
-            }
-        }
+// Adds a bit-sliced number (one word per binary digit, one bit per cell) into a 5-digit sum
+static inline void AddSliced(uint64_t (&sum)[5], const uint64_t (&value)[3])
+{
+    uint64_t carry = 0;
+    for (int i = 0; i < 5; i++)
+    {
+        uint64_t v = i < 3 ? value[i] : 0;
+        uint64_t a = sum[i];
+        sum[i] = a ^ v ^ carry;
+        carry = (a & v) | (carry & (a ^ v));
     }
-    return 0;
 }
 
-int Chunk::getBottom() const {
-    for (int y = GRID_DIMENSIONS - 1; y >= 0; y--) {
-        for (int x = 0; x < GRID_DIMENSIONS; x++) {
-            if (Grid[x][y] != 0) {
-                return y;
-            }
+// Cells whose bit-sliced sum equals value
+static inline uint64_t SlicedEquals(const uint64_t (&sum)[5], int value)
+{
+    uint64_t match = ~uint64_t(0);
+    for (int i = 0; i < 5; i++)
+        match &= ((value >> i) & 1) ? sum[i] : ~sum[i];
+    return match;
+}
+
+// Next generation of an outer-totalistic rule, 64 cells at a time and without touching the table:
+// each apron row is summed horizontally once, then every cell row adds up the 3 or 5 row sums around it
+// The sums include the centre, so a live cell with n neighbors shows up as n + 1
+static void StepTotalistic(const ChunkApron& apron, const TotalisticRule& rule, ChunkRows& next)
+{
+    int range = rule.Range;
+    uint64_t horizontal[GRID_DIMENSIONS + 4][3];
+    for (int r = 2 - range; r < GRID_DIMENSIONS + 2 + range; r++)
+    {
+        uint64_t a = ShiftedApronRow(apron, r, -1);
+        uint64_t b = apron.Rows[r];
+        uint64_t c = ShiftedApronRow(apron, r, 1);
+        uint64_t low = a ^ b ^ c;
+        uint64_t high = (a & b) | (c & (a ^ b));
+
+        if (range == 1)
+        {
+            horizontal[r][0] = low;
+            horizontal[r][1] = high;
+            horizontal[r][2] = 0;
+        }
+        else
+        {
+            uint64_t d = ShiftedApronRow(apron, r, -2);
+            uint64_t e = ShiftedApronRow(apron, r, 2);
+            uint64_t pairLow = d ^ e;
+            uint64_t pairHigh = d & e;
+            uint64_t carry = low & pairLow;
+            horizontal[r][0] = low ^ pairLow;
+            horizontal[r][1] = high ^ pairHigh ^ carry;
+            horizontal[r][2] = (high & pairHigh) | (carry & (high ^ pairHigh));
         }
     }
-    return 0;
+
+    for (int y = 0; y < GRID_DIMENSIONS; y++)
+    {
+        uint64_t sum[5] = {};
+        for (int r = y + 2 - range; r <= y + 2 + range; r++)
+            AddSliced(sum, horizontal[r]);
+
+        uint64_t born = 0;
+        for (uint32_t counts = rule.Birth; counts; counts &= counts - 1)
+            born |= SlicedEquals(sum, CountTrailingZeros64(counts));
+        uint64_t survives = 0;
+        for (uint32_t counts = rule.Survival; counts; counts &= counts - 1)
+            survives |= SlicedEquals(sum, CountTrailingZeros64(counts) + 1);
+
+        uint64_t centre = apron.Rows[y + 2];
+        next[y] = (born & ~centre) | (survives & centre);
+    }
 }
 
-int Chunk::getLeft() const {
-    for (int x = 0; x < GRID_DIMENSIONS; x++) {
-        for (int y = 0; y < GRID_DIMENSIONS; y++) {
-            if (Grid[x][y] != 0) {
-                return x;
-            }
+void Chunk::Simulate(const R2INTRules& rules, World& world)
+{
+    ChunkApron apron;
+    BuildApron(apron, world.VoidState, world.Parity);
+
+    ChunkRows next;
+    const ShapedRule* shaped = world.Shaped.get();
+    if (world.Totalistic.Range)
+        StepTotalistic(apron, world.Totalistic, next);
+    else if (shaped && shaped->Shape == SHAPE_DIAMOND)
+        StepTable(apron, [shaped](int t) { return shaped->Get(DiamondIndex(t)); }, next);
+    else if (shaped && shaped->Shape == SHAPE_OCTAGON)
+        StepTable(apron, [shaped](int t) { return shaped->Get(OctagonIndex(t)); }, next);
+    else
+        StepTable(apron, [&rules](int t) { return rules.Get(t); }, next);
+
+    // Write straight into the other buffer; the world flips Parity once every chunk is done
+    PreviousFill = Fill;
+    Fill = 0;
+    ChunkRows& newGrid = Buffers[world.Parity ^ 1];
+
+    // Difference against the generation being overwritten, and the live and dead cells of the new one, per edge band
+    uint64_t anyDiff = 0;
+    uint64_t northDiff = 0;
+    uint64_t southDiff = 0;
+    uint64_t anyLive = 0;
+    uint64_t allLive = ~uint64_t(0);
+    int top = GRID_DIMENSIONS;
+    int bottom = -1;
+
+    for (int y = 0; y < GRID_DIMENSIONS; y++)
+    {
+        uint64_t newRow = next[y];
+        uint64_t diff = newRow ^ newGrid[y];
+        anyDiff |= diff;
+        if (y < 2) northDiff |= diff;
+        if (y >= GRID_DIMENSIONS - 2) southDiff |= diff;
+        anyLive |= newRow;
+        allLive &= newRow;
+        if (newRow)
+        {
+            top = std::min(top, y);
+            bottom = y;
         }
+
+        newGrid[y] = newRow;
+        Fill += PopCount64(newRow);
     }
-    return 0;
+
+    ChangedMask = BandMask(anyDiff, northDiff, southDiff);
+
+    uint8_t written = world.Parity ^ 1;
+    LiveBorder[written] = BandMask(anyLive, next[0] | next[1], next[GRID_DIMENSIONS - 2] | next[GRID_DIMENSIONS - 1]);
+    DeadBorder[written] = BandMask(~allLive, ~(next[0] & next[1]), ~(next[GRID_DIMENSIONS - 2] & next[GRID_DIMENSIONS - 1]));
+    LiveColumns[written] = anyLive;
+    TopRow[written] = static_cast<int8_t>(top);
+    BottomRow[written] = static_cast<int8_t>(bottom);
 }
 
-int Chunk::getRight() const {
-    for (int x = GRID_DIMENSIONS - 1; x >= 0; x--) {
-        for (int y = 0; y < GRID_DIMENSIONS; y++) {
-            if (Grid[x][y] != 0) {
-                return x;
-            }
+// A chunk has to be stepped if it changed, or a neighbor changed the border cells it reads
+// Otherwise its input repeats the one from two generations ago, and so does its output
+bool Chunk::NeedsStep() const
+{
+    if (ForceStep || (ChangedMask & CHUNK_CHANGED_SELF))
+        return true;
+
+    for (int dy = -1; dy <= 1; dy++)
+    {
+        for (int dx = -1; dx <= 1; dx++)
+        {
+            const Chunk* neighbor = neighborGrids[dx + 1][dy + 1];
+            if (neighbor && neighbor != this && (neighbor->ChangedMask & ChangedBit(-dx, -dy)))
+                return true;
         }
     }
-    return 0;
+    return false;
+}
+
+// The other buffer already holds this chunk's next generation, so only the population needs swapping
+void Chunk::SkipStep()
+{
+    std::swap(Fill, PreviousFill);
+}
+
+// Components of GetRect, read off the bounds Simulate and painting keep; 0 for an empty buffer
+int Chunk::getTop(uint8_t parity) const {
+    return LiveColumns[parity] ? TopRow[parity] : 0;
 }
 
-sf::IntRect Chunk::GetRect() const {
-    int top = getTop();
-    int bottom = getBottom();
-    int left = getLeft();
-    int right = getRight();
-    if (top == -1 || bottom == -1 || left == -1 || right == -1) {
+int Chunk::getBottom(uint8_t parity) const {
+    return LiveColumns[parity] ? BottomRow[parity] : 0;
+}
+
+int Chunk::getLeft(uint8_t parity) const {
+    uint64_t columns = LiveColumns[parity];
+    return columns ? CountLeadingZeros64(columns) : 0;
+}
+
+int Chunk::getRight(uint8_t parity) const {
+    uint64_t columns = LiveColumns[parity];
+    return columns ? GRID_DIMENSIONS - 1 - CountTrailingZeros64(columns) : 0;
+}
+
+sf::IntRect Chunk::GetRect(uint8_t parity) const {
+    if (!LiveColumns[parity]) {
         return sf::IntRect({ -1, -1 }, { -1, -1 });
     }
-    return sf::IntRect({ left, top }, { right - left + 1, bottom - top + 1 });
-}
\ No newline at end of file
+    int top = getTop(parity);
+    int left = getLeft(parity);
+    return sf::IntRect({ left, top }, { getRight(parity) - left + 1, getBottom(parity) - top + 1 });
+}
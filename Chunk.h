@@ -1,13 +1,24 @@
 #pragma once
-#include <SFML/Graphics.hpp>
+#include "Geometry.h"
 #include <array>
 #include <vector>
 #include <random>
 #include <unordered_map>
+#include <cstdint>
 #include "OffsetStruct.h"
 
 #define GRID_DIMENSIONS 64
 
+// One uint64_t per row, cell x stored at bit 63 - x so rows read left to right from the top bit
+typedef std::array<uint64_t, GRID_DIMENSIONS> ChunkRows;
+
+static_assert(GRID_DIMENSIONS == 64, "Chunk rows are packed into 64-bit words");
+
+inline uint64_t CellMask(int x)
+{
+	return uint64_t(1) << (GRID_DIMENSIONS - 1 - x);
+}
+
 struct GridCoord {
 	int x, y;
 
@@ -16,47 +27,103 @@ struct GridCoord {
 	}
 };
 
+// Both coordinates packed into 64 bits and run through the splitmix64 finalizer,
+// so neighboring chunks land in unrelated buckets instead of colliding like x ^ (y << 1) does
+inline uint64_t HashGridCoord(const GridCoord& p)
+{
+	uint64_t h = (uint64_t(uint32_t(p.x)) << 32) | uint32_t(p.y);
+	h = (h ^ (h >> 30)) * 0xBF58476D1CE4E5B9ull;
+	h = (h ^ (h >> 27)) * 0x94D049BB133111EBull;
+	return h ^ (h >> 31);
+}
+
 namespace std {
 	template<>
 	struct hash<GridCoord> {
 		std::size_t operator()(const GridCoord& p) const {
-			return std::hash<int>{}(p.x) ^ (std::hash<int>{}(p.y) << 1);
+			return static_cast<std::size_t>(HashGridCoord(p));
 		}
 	};
 }
 
 struct World;
 
+// ChangedMask bits: bit (dy + 1) * 3 + (dx + 1) is set when the last step changed a cell
+// within 2 cells of the neighbor at (dx, dy); the center bit means anything changed
+inline int ChangedBit(int dx, int dy)
+{
+	return 1 << ((dy + 1) * 3 + (dx + 1));
+}
+
+#define CHUNK_CHANGED_SELF 0x010
+#define CHUNK_CHANGED_ALL  0x1FF
+
+// Previous generation of a chunk plus a 2-cell border from its neighbors (68x68 cells)
+// Apron row r holds cell row r - 2; Left/Right hold the 2 cells past each end of the row
+struct ChunkApron {
+	std::array<uint64_t, GRID_DIMENSIONS + 4> Rows;
+	std::array<uint8_t, GRID_DIMENSIONS + 4> Left;   // Cell -2 in bit 1, cell -1 in bit 0
+	std::array<uint8_t, GRID_DIMENSIONS + 4> Right;  // Cell 64 in bit 1, cell 65 in bit 0
+};
+
 struct Chunk {
 	int CoordinateX;
 	int CoordinateY;
-	unsigned __int16 Fill;
+	uint16_t Fill;
+	uint16_t PreviousFill; // Fill of the other buffer, swapped in when a step is skipped
+
+	// Change tracking compares each new generation against the one two steps back (the buffer it overwrites),
+	// so chunks that are still or period 2 can skip stepping by leaving that buffer in place
+	uint16_t ChangedMask = CHUNK_CHANGED_ALL;
+	bool ForceStep = false; // Set when a neighbor disappears while its facing border was still changing
+
+	// Border summaries of each buffer in the ChangedMask layout: bit (dx, dy) is set when a cell within 2 cells
+	// of that neighbor is alive (LiveBorder) or dead (DeadBorder); the center bit covers the whole chunk
+	// Painting a live cell only adds bits, so a summary may overstate a border until the next step but never understates it
+	uint16_t LiveBorder[2] = { 0, 0 };
+	uint16_t DeadBorder[2] = { CHUNK_CHANGED_ALL, CHUNK_CHANGED_ALL };
 
-    std::array<std::array<__int8, GRID_DIMENSIONS>, GRID_DIMENSIONS> Grid;
-    std::array<std::array<__int8, GRID_DIMENSIONS>, GRID_DIMENSIONS> OldGrid;
+	// Bounds of each buffer's live cells: every occupied column OR'd over all rows, and the first and last occupied row
+	// Kept exact by Simulate and painting, so GetRect never scans the rows (erasing may leave an inner column set; only the edges are read)
+	uint64_t LiveColumns[2] = { 0, 0 };
+	int8_t TopRow[2] = { GRID_DIMENSIONS, GRID_DIMENSIONS }; // GRID_DIMENSIONS when empty
+	int8_t BottomRow[2] = { -1, -1 };                        // -1 when empty
+
+    // Two generation buffers; World::Parity says which one holds the current generation
+    // Simulate reads Buffers[parity] and writes Buffers[parity ^ 1], so a generation swaps roles instead of copying
+    ChunkRows Buffers[2];
 
 	Chunk* neighborGrids[3][3] = {}; // Center = [1][1]
 
 	Chunk(); // empty
 	Chunk(int x, int y);
 
-	__int8 GetCellStateAt(sf::Vector2i localXY) const;
+	ChunkRows& Rows(uint8_t parity) { return Buffers[parity]; }
+	const ChunkRows& Rows(uint8_t parity) const { return Buffers[parity]; }
+
+	// Local cell access; SetCell writes both buffers like painting does
+	int8_t GetCell(int x, int y, uint8_t parity) const { return (Buffers[parity][y] & CellMask(x)) != 0; }
+	void SetCell(int x, int y, int8_t state);
 
 	void Clear();
     void FillWithVoidState(char voidState);
 	void RandomizeRect(sf::Rect<int> RandomizedSection, bool Delete, std::mt19937& gen);
 
+	// Neighbors that a non-void cell of the buffer can reach
+	uint16_t BorderMask(int8_t voidState, uint8_t parity) const { return voidState ? DeadBorder[parity] : LiveBorder[parity]; }
+	void UpdateSummaries(); // Recomputes the border summaries and bounds of both buffers from the rows
+
+	void BuildApron(ChunkApron& apron, int8_t voidState, uint8_t parity) const;
 	void Simulate(const R2INTRules& Rules, World& world);
-	void ResetOld();
+	bool NeedsStep() const;
+	void SkipStep();
 
     void EnsureNeighborsExist(World& world) const;
-	
-	bool NeedsNeighbors(__int8 voidState) const;
-
-    // GetRect member functions; returns local coordinates
-    int getTop() const;
-    int getBottom() const;
-    int getLeft() const;
-    int getRight() const;
-    sf::IntRect GetRect() const;
+
+    // GetRect member functions; returns local coordinates, and an empty rect ({ -1, -1 }, { -1, -1 }) for an empty buffer
+    int getTop(uint8_t parity) const;
+    int getBottom(uint8_t parity) const;
+    int getLeft(uint8_t parity) const;
+    int getRight(uint8_t parity) const;
+    sf::IntRect GetRect(uint8_t parity) const;
 };
\ No newline at end of file
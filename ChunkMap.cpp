@@ -0,0 +1,190 @@
+#include "ChunkMap.h"
+#include <algorithm>
+
+Chunk* ChunkPool::Allocate(int x, int y)
+{
+    if (freeList.empty())
+    {
+        slabs.emplace_back(new Chunk[CHUNK_POOL_SLAB]);
+        Chunk* slab = slabs.back().get();
+
+        // Hand slots out from the front of the slab
+        for (int i = CHUNK_POOL_SLAB - 1; i >= 0; i--)
+            freeList.push_back(&slab[i]);
+    }
+
+    Chunk* chunk = freeList.back();
+    freeList.pop_back();
+
+    *chunk = Chunk(x, y);
+    chunk->neighborGrids[1][1] = chunk;
+    return chunk;
+}
+
+void ChunkPool::Release(Chunk* chunk)
+{
+    freeList.push_back(chunk);
+}
+
+void ChunkPool::Reset()
+{
+    freeList.clear();
+    for (auto slab = slabs.rbegin(); slab != slabs.rend(); ++slab)
+    {
+        for (int i = CHUNK_POOL_SLAB - 1; i >= 0; i--)
+            freeList.push_back(&(*slab)[i]);
+    }
+}
+
+// Spreads the 32 bits of v over the even bits of the result
+static uint64_t SpreadBits(uint32_t v)
+{
+    uint64_t x = v;
+    x = (x | (x << 16)) & 0x0000FFFF0000FFFFull;
+    x = (x | (x << 8)) & 0x00FF00FF00FF00FFull;
+    x = (x | (x << 4)) & 0x0F0F0F0F0F0F0F0Full;
+    x = (x | (x << 2)) & 0x3333333333333333ull;
+    x = (x | (x << 1)) & 0x5555555555555555ull;
+    return x;
+}
+
+uint64_t SpatialKey(GridCoord coord)
+{
+    // Flipping the sign bits orders negative coordinates before positive ones
+    return SpreadBits(uint32_t(coord.x) ^ 0x80000000u) | (SpreadBits(uint32_t(coord.y) ^ 0x80000000u) << 1);
+}
+
+ChunkMap::ChunkMap(const ChunkMap& other)
+{
+    *this = other;
+}
+
+ChunkMap& ChunkMap::operator=(const ChunkMap& other)
+{
+    if (this == &other)
+        return *this;
+
+    Clear();
+    for (const Chunk* source : other.chunks)
+    {
+        Chunk& chunk = Insert({ source->CoordinateX, source->CoordinateY });
+        chunk = *source;
+        Link(&chunk); // The copied links point into the other map
+    }
+    sorted = other.sorted;
+    return *this;
+}
+
+void ChunkMap::Grow()
+{
+    std::size_t size = std::max<std::size_t>(CHUNK_INDEX_MIN_SLOTS, slots.size() * 2);
+    slots.assign(size, Slot());
+    for (std::size_t d = 0; d < chunks.size(); d++)
+    {
+        GridCoord coord = { chunks[d]->CoordinateX, chunks[d]->CoordinateY };
+        slots[FindSlot(coord)] = { coord, chunks[d], static_cast<int>(d) };
+    }
+}
+
+Chunk& ChunkMap::Insert(GridCoord coord)
+{
+    if ((chunks.size() + 1) * 2 > slots.size())
+        Grow();
+
+    std::size_t i = FindSlot(coord);
+    if (slots[i].Value)
+        return *slots[i].Value;
+
+    Chunk* chunk = pool.Allocate(coord.x, coord.y);
+    slots[i] = { coord, chunk, static_cast<int>(chunks.size()) };
+    chunks.push_back(chunk);
+    sorted = false;
+
+    Link(chunk);
+    return *chunk;
+}
+
+void ChunkMap::Erase(GridCoord coord)
+{
+    if (slots.empty())
+        return;
+
+    std::size_t hole = FindSlot(coord);
+    Slot& slot = slots[hole];
+    if (!slot.Value)
+        return;
+
+    // Fill the chunk's place in the dense array with the last chunk
+    Chunk* last = chunks.back();
+    chunks[slot.Dense] = last;
+    slots[FindSlot({ last->CoordinateX, last->CoordinateY })].Dense = slot.Dense;
+    chunks.pop_back();
+    Unlink(slot.Value);
+    pool.Release(slot.Value);
+    sorted = false;
+
+    // Shift later entries of the probe sequence back into the hole, so lookups never need tombstones
+    std::size_t mask = slots.size() - 1;
+    for (std::size_t j = (hole + 1) & mask; slots[j].Value; j = (j + 1) & mask)
+    {
+        std::size_t home = static_cast<std::size_t>(HashGridCoord(slots[j].Key)) & mask;
+        if (((j - home) & mask) >= ((j - hole) & mask))
+        {
+            slots[hole] = slots[j];
+            hole = j;
+        }
+    }
+    slots[hole] = Slot();
+}
+
+void ChunkMap::Link(Chunk* chunk)
+{
+    for (int dy = -1; dy <= 1; dy++)
+    {
+        for (int dx = -1; dx <= 1; dx++)
+        {
+            if (dx == 0 && dy == 0)
+                continue;
+
+            Chunk* neighbor = Find({ chunk->CoordinateX + dx, chunk->CoordinateY + dy });
+            chunk->neighborGrids[dx + 1][dy + 1] = neighbor;
+            if (neighbor)
+                neighbor->neighborGrids[1 - dx][1 - dy] = chunk;
+        }
+    }
+    chunk->neighborGrids[1][1] = chunk;
+}
+
+void ChunkMap::Unlink(Chunk* chunk)
+{
+    for (int dy = -1; dy <= 1; dy++)
+    {
+        for (int dx = -1; dx <= 1; dx++)
+        {
+            Chunk* neighbor = chunk->neighborGrids[dx + 1][dy + 1];
+            if (neighbor && neighbor != chunk)
+                neighbor->neighborGrids[1 - dx][1 - dy] = nullptr;
+        }
+    }
+}
+
+void ChunkMap::Clear()
+{
+    std::fill(slots.begin(), slots.end(), Slot());
+    chunks.clear();
+    pool.Reset();
+    sorted = true;
+}
+
+void ChunkMap::SortSpatially()
+{
+    if (sorted)
+        return;
+
+    std::sort(chunks.begin(), chunks.end(), [](const Chunk* a, const Chunk* b) {
+        return SpatialKey({ a->CoordinateX, a->CoordinateY }) < SpatialKey({ b->CoordinateX, b->CoordinateY });
+        });
+    for (std::size_t d = 0; d < chunks.size(); d++)
+        slots[FindSlot({ chunks[d]->CoordinateX, chunks[d]->CoordinateY })].Dense = static_cast<int>(d);
+    sorted = true;
+}
@@ -0,0 +1,116 @@
+#pragma once
+#include "Chunk.h"
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+// Chunks per slab; a chunk is about 1.1 KB (two buffers plus summaries and neighbor links), so a slab is about 70 KB
+#define CHUNK_POOL_SLAB 64
+static_assert(sizeof(Chunk) * CHUNK_POOL_SLAB <= 96 * 1024, "Slabs grew past the size noted above");
+
+// Smallest index table, in slots; it doubles whenever it would get more than half full
+#define CHUNK_INDEX_MIN_SLOTS 64
+
+// Allocates chunks out of fixed slabs and recycles released ones through a free list,
+// so a chunk never moves while it's in use and steady churn doesn't touch the heap
+class ChunkPool {
+public:
+    ChunkPool() = default;
+    ChunkPool(const ChunkPool&) = delete;
+    ChunkPool& operator=(const ChunkPool&) = delete;
+    ChunkPool(ChunkPool&&) noexcept = default;
+    ChunkPool& operator=(ChunkPool&&) noexcept = default;
+
+    Chunk* Allocate(int x, int y); // An empty chunk at (x, y)
+    void Release(Chunk* chunk);
+    void Reset(); // Releases every chunk but keeps the slabs
+
+    std::size_t Capacity() const { return slabs.size() * CHUNK_POOL_SLAB; }
+
+private:
+    std::vector<std::unique_ptr<Chunk[]>> slabs;
+    std::vector<Chunk*> freeList;
+};
+
+// Z-order (Morton) key: nearby chunks get nearby keys, so sorting by it groups them spatially
+uint64_t SpatialKey(GridCoord coord);
+
+// The world's chunks by coordinate
+// Chunks live in a ChunkPool, so pointers to them stay valid until the chunk is erased
+// neighborGrids is kept up to date here: Insert links a new chunk both ways with the chunks around it,
+// and Erase clears the links back to it, so stepping never has to relink
+// Lookups go through a flat open-addressing table (linear probing on HashGridCoord, no tombstones),
+// and iteration walks a dense array of the chunks that SortSpatially() puts in Z-order
+// Copies get their own chunks, linked among themselves
+class ChunkMap {
+public:
+    // Walks the chunks as Chunk&
+    template <typename Value>
+    class BasicIterator {
+        using DenseIterator = std::vector<Chunk*>::const_iterator;
+
+    public:
+        explicit BasicIterator(DenseIterator it) : it(it) {}
+
+        Value& operator*() const { return **it; }
+        Value* operator->() const { return *it; }
+        BasicIterator& operator++() { ++it; return *this; }
+        bool operator==(const BasicIterator& other) const { return it == other.it; }
+        bool operator!=(const BasicIterator& other) const { return it != other.it; }
+
+    private:
+        DenseIterator it;
+    };
+    using iterator = BasicIterator<Chunk>;
+    using const_iterator = BasicIterator<const Chunk>;
+
+    ChunkMap() = default;
+    ChunkMap(const ChunkMap& other);
+    ChunkMap& operator=(const ChunkMap& other);
+    ChunkMap(ChunkMap&&) noexcept = default;
+    ChunkMap& operator=(ChunkMap&&) noexcept = default;
+
+    Chunk* Find(GridCoord coord) { return slots.empty() ? nullptr : slots[FindSlot(coord)].Value; }
+    const Chunk* Find(GridCoord coord) const { return slots.empty() ? nullptr : slots[FindSlot(coord)].Value; }
+    Chunk& Insert(GridCoord coord); // The chunk at coord, created empty if there isn't one
+    void Erase(GridCoord coord);
+    void Clear();
+
+    // Puts the iteration order back in Z-order after chunks were added or erased; free otherwise
+    void SortSpatially();
+
+    std::size_t Size() const { return chunks.size(); }
+    bool Empty() const { return chunks.empty(); }
+    std::size_t PoolCapacity() const { return pool.Capacity(); }
+
+    iterator begin() { return iterator(chunks.begin()); }
+    iterator end() { return iterator(chunks.end()); }
+    const_iterator begin() const { return const_iterator(chunks.begin()); }
+    const_iterator end() const { return const_iterator(chunks.end()); }
+
+private:
+    struct Slot {
+        GridCoord Key;
+        Chunk* Value = nullptr; // nullptr = empty slot
+        int Dense = 0;          // Position of the chunk in chunks
+    };
+
+    // The slot holding coord, or the empty slot that ends its probe sequence
+    std::size_t FindSlot(GridCoord coord) const
+    {
+        std::size_t mask = slots.size() - 1;
+        std::size_t i = static_cast<std::size_t>(HashGridCoord(coord)) & mask;
+        while (slots[i].Value && !(slots[i].Key == coord))
+            i = (i + 1) & mask;
+        return i;
+    }
+
+    void Grow();
+    void Link(Chunk* chunk);
+    void Unlink(Chunk* chunk);
+
+    ChunkPool pool;
+    std::vector<Slot> slots; // Power-of-two size
+    std::vector<Chunk*> chunks;
+    bool sorted = true;
+};
@@ -0,0 +1,205 @@
+#include "ChunkRenderer.h"
+#include "BitOps.h"
+#include <iostream>
+
+#define RENDER_PAGE_SLOTS (RENDER_PAGE_CHUNKS * RENDER_PAGE_CHUNKS)
+#define RENDER_PAGE_TEXELS (RENDER_PAGE_CHUNKS * GRID_DIMENSIONS)
+
+int ChunkRenderer::AllocateSlot()
+{
+    if (!freeSlots.empty())
+    {
+        int slot = freeSlots.back();
+        freeSlots.pop_back();
+        return slot;
+    }
+
+    // Every page is full; start a new one
+    if (slotCount % RENDER_PAGE_SLOTS == 0)
+    {
+        auto page = std::make_unique<sf::Texture>();
+        if (!page->resize({ RENDER_PAGE_TEXELS, RENDER_PAGE_TEXELS }))
+            std::cerr << "Failed to create chunk texture page!\n";
+
+        pages.push_back(std::move(page));
+        pageVertices.emplace_back(sf::PrimitiveType::Triangles);
+    }
+
+    return slotCount++;
+}
+
+// Background blended towards the live color by the fraction of live cells
+// Anything alive gets at least a quarter of the way, so sparse patterns stay visible when zoomed out
+static sf::Color DensityColor(const sf::Color& background, const sf::Color& alive, int count, int total)
+{
+    if (count == 0)
+        return background;
+
+    float t = 0.25f + 0.75f * count / total;
+    auto Mix = [t](std::uint8_t from, std::uint8_t to) {
+        return static_cast<std::uint8_t>(from + (to - from) * t);
+    };
+    return sf::Color(Mix(background.r, alive.r), Mix(background.g, alive.g), Mix(background.b, alive.b), Mix(background.a, alive.a));
+}
+
+// Texels per side a slot uses at each level of detail
+static int LodTexels(int lod)
+{
+    return lod == RENDER_LOD_CELLS ? GRID_DIMENSIONS : lod == RENDER_LOD_BLOCKS ? GRID_DIMENSIONS / 8 : 1;
+}
+
+void ChunkRenderer::Upload(const Tile& tile, const std::vector<sf::Color>& colors)
+{
+    const sf::Color background(0, 0, 0); // Fixed background, as before
+    const sf::Color alive = colors[1];
+
+    int texels = LodTexels(tile.Lod);
+    pixels.resize(texels * texels * 4);
+    std::uint8_t* pixel = pixels.data();
+
+    auto Put = [&pixel](const sf::Color& color) {
+        *pixel++ = color.r;
+        *pixel++ = color.g;
+        *pixel++ = color.b;
+        *pixel++ = color.a;
+    };
+
+    if (tile.Lod == RENDER_LOD_CELLS)
+    {
+        for (int y = 0; y < GRID_DIMENSIONS; y++)
+        {
+            uint64_t row = tile.Rows[y];
+            for (int x = 0; x < GRID_DIMENSIONS; x++)
+                Put((row & CellMask(x)) ? alive : background);
+        }
+    }
+    else if (tile.Lod == RENDER_LOD_BLOCKS)
+    {
+        for (int by = 0; by < 8; by++)
+        {
+            int counts[8] = {};
+            for (int y = by * 8; y < by * 8 + 8; y++)
+            {
+                for (int bx = 0; bx < 8; bx++)
+                    counts[bx] += PopCount64((tile.Rows[y] >> (56 - bx * 8)) & 0xFF);
+            }
+
+            for (int bx = 0; bx < 8; bx++)
+                Put(DensityColor(background, alive, counts[bx], 64));
+        }
+    }
+    else
+    {
+        int count = 0;
+        for (uint64_t row : tile.Rows)
+            count += PopCount64(row);
+        Put(DensityColor(background, alive, count, GRID_DIMENSIONS * GRID_DIMENSIONS));
+    }
+
+    int page = tile.Slot / RENDER_PAGE_SLOTS;
+    int index = tile.Slot % RENDER_PAGE_SLOTS;
+    sf::Vector2u destination(
+        static_cast<unsigned>(index % RENDER_PAGE_CHUNKS * GRID_DIMENSIONS),
+        static_cast<unsigned>(index / RENDER_PAGE_CHUNKS * GRID_DIMENSIONS));
+
+    pages[page]->update(pixels.data(), { static_cast<unsigned>(texels), static_cast<unsigned>(texels) }, destination);
+    uploadsLastFrame++;
+}
+
+void ChunkRenderer::Draw(sf::RenderTarget& target, const World& world, const std::vector<sf::Color>& colors)
+{
+    frame++;
+    uploadsLastFrame = 0;
+    chunksDrawnLastFrame = 0;
+
+    bool recolor = colors != uploadedColors;
+    uploadedColors = colors;
+
+    for (sf::VertexArray& vertices : pageVertices)
+        vertices.clear();
+
+    float chunkSize = GRID_DIMENSIONS * world.cellSize;
+
+    // Visible world rectangle (rotated views aren't used, so the axis-aligned one is exact)
+    const sf::View& view = target.getView();
+    sf::Vector2f viewMin = view.getCenter() - view.getSize() / 2.f;
+    sf::Vector2f viewMax = view.getCenter() + view.getSize() / 2.f;
+
+    // Pick the level of detail from how many screen pixels a cell covers
+    float pixelsPerCell = world.cellSize * target.getSize().x * view.getViewport().size.x / view.getSize().x;
+    int lod = pixelsPerCell >= RENDER_LOD_BLOCK_ZOOM ? RENDER_LOD_CELLS :
+        pixelsPerCell >= RENDER_LOD_CHUNK_ZOOM ? RENDER_LOD_BLOCKS : RENDER_LOD_CHUNKS;
+    lodLastFrame = lod;
+    float texels = static_cast<float>(LodTexels(lod));
+
+    for (const Chunk& chunk : world.contents)
+    {
+        GridCoord coord = { chunk.CoordinateX, chunk.CoordinateY };
+        float x = coord.x * chunkSize;
+        float y = coord.y * chunkSize;
+        bool visible = x + chunkSize > viewMin.x && x < viewMax.x && y + chunkSize > viewMin.y && y < viewMax.y;
+
+        auto it = tiles.find(coord);
+        if (it != tiles.end())
+            it->second.LastSeen = frame;
+        if (!visible)
+            continue; // Off-screen tiles keep their slot but aren't refreshed until they come back into view
+
+        const ChunkRows& rows = chunk.Rows(world.Parity);
+
+        if (it == tiles.end())
+        {
+            it = tiles.emplace(coord, Tile{ AllocateSlot(), rows, lod, frame }).first;
+            Upload(it->second, colors);
+        }
+        else
+        {
+            Tile& tile = it->second;
+            if (recolor || tile.Lod != lod || tile.Rows != rows)
+            {
+                tile.Rows = rows;
+                tile.Lod = lod;
+                Upload(tile, colors);
+            }
+        }
+
+        // One quad per chunk, textured with (part of) its slot
+        int index = it->second.Slot % RENDER_PAGE_SLOTS;
+        float u = static_cast<float>(index % RENDER_PAGE_CHUNKS * GRID_DIMENSIONS);
+        float v = static_cast<float>(index / RENDER_PAGE_CHUNKS * GRID_DIMENSIONS);
+
+        sf::Vertex topLeft{ { x, y }, sf::Color::White, { u, v } };
+        sf::Vertex topRight{ { x + chunkSize, y }, sf::Color::White, { u + texels, v } };
+        sf::Vertex bottomLeft{ { x, y + chunkSize }, sf::Color::White, { u, v + texels } };
+        sf::Vertex bottomRight{ { x + chunkSize, y + chunkSize }, sf::Color::White, { u + texels, v + texels } };
+
+        sf::VertexArray& vertices = pageVertices[it->second.Slot / RENDER_PAGE_SLOTS];
+        vertices.append(topLeft);
+        vertices.append(bottomLeft);
+        vertices.append(topRight);
+        vertices.append(topRight);
+        vertices.append(bottomLeft);
+        vertices.append(bottomRight);
+        chunksDrawnLastFrame++;
+    }
+
+    // Hand the slots of chunks that no longer exist to new ones
+    for (auto it = tiles.begin(); it != tiles.end(); )
+    {
+        if (it->second.LastSeen != frame)
+        {
+            freeSlots.push_back(it->second.Slot);
+            it = tiles.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+
+    for (size_t page = 0; page < pages.size(); page++)
+    {
+        if (pageVertices[page].getVertexCount() > 0)
+            target.draw(pageVertices[page], pages[page].get());
+    }
+}
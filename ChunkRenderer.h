@@ -0,0 +1,57 @@
+#pragma once
+#include <SFML/Graphics.hpp>
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+#include "World.h"
+
+// Chunk slots per side of an atlas page (32 * 64 = 2048 texels, which every GPU supports)
+#define RENDER_PAGE_CHUNKS 32
+
+// Screen pixels per cell below which chunks are drawn as density summaries instead of cells
+#define RENDER_LOD_BLOCK_ZOOM 1.0f    // 8x8 texels per chunk, one per 8x8 block of cells
+#define RENDER_LOD_CHUNK_ZOOM 0.125f  // 1 texel per chunk
+
+#define RENDER_LOD_CELLS 0
+#define RENDER_LOD_BLOCKS 1
+#define RENDER_LOD_CHUNKS 2
+
+// Draws a World with one texel per cell
+// Every chunk owns a 64x64 slot in an atlas page that is only re-uploaded when the chunk's cells differ
+// from what was last uploaded; each page is then drawn as one vertex array with one quad per chunk
+// Chunks outside the target's view are skipped entirely, and zoomed out far enough that cells are
+// smaller than a pixel, slots hold downsampled density summaries instead (see RENDER_LOD_*)
+class ChunkRenderer {
+public:
+    void Draw(sf::RenderTarget& target, const World& world, const std::vector<sf::Color>& colors);
+
+    int UploadsLastFrame() const { return uploadsLastFrame; }
+    int ChunksDrawnLastFrame() const { return chunksDrawnLastFrame; }
+    int LodLastFrame() const { return lodLastFrame; }
+
+private:
+    struct Tile {
+        int Slot;
+        ChunkRows Rows;    // Cells as of the last upload
+        int Lod;           // RENDER_LOD_* of the last upload
+        uint64_t LastSeen; // Frame the chunk last existed in
+    };
+
+    int AllocateSlot();
+    void Upload(const Tile& tile, const std::vector<sf::Color>& colors);
+
+    std::unordered_map<GridCoord, Tile> tiles;
+    std::vector<std::unique_ptr<sf::Texture>> pages;
+    std::vector<sf::VertexArray> pageVertices;
+    std::vector<int> freeSlots;
+    int slotCount = 0;
+
+    std::vector<sf::Color> uploadedColors; // A palette change re-uploads everything
+    std::vector<std::uint8_t> pixels;      // RGBA scratch for one slot
+
+    uint64_t frame = 0;
+    int uploadsLastFrame = 0;
+    int chunksDrawnLastFrame = 0;
+    int lodLastFrame = RENDER_LOD_CELLS;
+};
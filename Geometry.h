@@ -0,0 +1,36 @@
+#pragma once
+
+// Vector and rectangle types used by the simulation core
+// The app uses SFML's; headless builds (R2INT_HEADLESS) get stand-ins with the same members,
+// so the core compiles without SFML installed
+#ifdef R2INT_HEADLESS
+namespace sf {
+    template <typename T>
+    struct Vector2 {
+        T x = 0;
+        T y = 0;
+
+        constexpr Vector2() = default;
+        constexpr Vector2(T X, T Y) : x(X), y(Y) {}
+    };
+    using Vector2i = Vector2<int>;
+    using Vector2f = Vector2<float>;
+
+    template <typename T>
+    struct Rect {
+        Vector2<T> position;
+        Vector2<T> size;
+
+        constexpr Rect() = default;
+        constexpr Rect(Vector2<T> Position, Vector2<T> Size) : position(Position), size(Size) {}
+
+        constexpr bool contains(Vector2<T> point) const {
+            return point.x >= position.x && point.x < position.x + size.x &&
+                point.y >= position.y && point.y < position.y + size.y;
+        }
+    };
+    using IntRect = Rect<int>;
+}
+#else
+#include <SFML/Graphics.hpp>
+#endif
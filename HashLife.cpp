@@ -0,0 +1,437 @@
+#include "HashLife.h"
+#include "BitOps.h"
+#include <algorithm>
+#include <functional>
+
+//
+// Leaf helpers
+//
+
+// Row y of a leaf, cell x at bit 7 - x
+static inline unsigned LeafRow(uint64_t leaf, int y)
+{
+    return static_cast<unsigned>(leaf >> ((7 - y) * 8)) & 0xFF;
+}
+
+// Lay four leaves out as a 16x16 block, cell x at bit 15 - x of each row
+static void CombineLeaves(uint64_t nw, uint64_t ne, uint64_t sw, uint64_t se, uint16_t rows[16])
+{
+    for (int y = 0; y < 8; y++)
+    {
+        rows[y] = static_cast<uint16_t>(LeafRow(nw, y) << 8 | LeafRow(ne, y));
+        rows[y + 8] = static_cast<uint16_t>(LeafRow(sw, y) << 8 | LeafRow(se, y));
+    }
+}
+
+// The 8x8 block at (4, 4) of a 16x16 block
+static uint64_t CentreLeaf(const uint16_t rows[16])
+{
+    uint64_t leaf = 0;
+    for (int y = 0; y < 8; y++)
+        leaf |= static_cast<uint64_t>((rows[y + 4] >> 4) & 0xFF) << ((7 - y) * 8);
+    return leaf;
+}
+
+// One generation of a 16x16 block; only cells at least margin away from the edge are written
+// (margin must be at least 2, since that is as far as the inputs are known)
+static void StepBlock(const uint16_t in[16], uint16_t out[16], int margin, const R2INTRules& rules)
+{
+    for (int y = margin; y < 16 - margin; y++)
+    {
+        uint16_t row = 0;
+        for (int x = margin; x < 16 - margin; x++)
+        {
+            int shift = 13 - x; // Puts cell x - 2 at bit 4 of the row window
+            int neighborhoodInt = ((in[y - 2] >> shift) & 31) << 20 | ((in[y - 1] >> shift) & 31) << 15 |
+                ((in[y] >> shift) & 31) << 10 | ((in[y + 1] >> shift) & 31) << 5 | ((in[y + 2] >> shift) & 31);
+
+            if (rules.Get(neighborhoodInt))
+                row |= static_cast<uint16_t>(1 << (15 - x));
+        }
+        out[y] = row;
+    }
+}
+
+//
+// Node store
+//
+
+std::size_t HashLifeUniverse::NodeKeyHash::operator()(const NodeKey& key) const
+{
+    uint64_t h = (static_cast<uint64_t>(key.Children[0]) << 32 | key.Children[1]) * 0x9E3779B97F4A7C15ull;
+    h ^= (static_cast<uint64_t>(key.Children[2]) << 32 | key.Children[3]) * 0xC2B2AE3D27D4EB4Full;
+    return static_cast<std::size_t>(h ^ (h >> 29));
+}
+
+std::size_t HashLifeUniverse::LeafHash::operator()(uint64_t leaf) const
+{
+    leaf ^= leaf >> 33;
+    leaf *= 0xFF51AFD7ED558CCDull;
+    leaf ^= leaf >> 33;
+    return static_cast<std::size_t>(leaf);
+}
+
+HashLifeUniverse::HashLifeUniverse()
+{
+    Reset();
+}
+
+void HashLifeUniverse::Reset()
+{
+    nodes.clear();
+    nodes.push_back(HashLifeNode{}); // Index 0 means "no node"
+    innerTable.clear();
+    leafTable.clear();
+    emptyNodes.clear();
+    root = EmptyNode(HASHLIFE_MIN_LEVEL);
+}
+
+void HashLifeUniverse::SetRule(const R2INTRules& rules)
+{
+    if (&rules == rule && rules.Version == ruleVersion)
+        return;
+
+    rule = &rules;
+    ruleVersion = rules.Version;
+    Reset();
+}
+
+uint32_t HashLifeUniverse::MakeLeaf(uint64_t bits)
+{
+    auto it = leafTable.find(bits);
+    if (it != leafTable.end())
+        return it->second;
+
+    HashLifeNode node = {};
+    node.Leaf = bits;
+    node.ResultExponent = -1;
+    node.Level = 3;
+    node.Empty = bits == 0;
+
+    uint32_t index = static_cast<uint32_t>(nodes.size());
+    nodes.push_back(node);
+    leafTable.emplace(bits, index);
+    return index;
+}
+
+uint32_t HashLifeUniverse::Join(uint32_t nw, uint32_t ne, uint32_t sw, uint32_t se)
+{
+    NodeKey key = { { nw, ne, sw, se } };
+    auto it = innerTable.find(key);
+    if (it != innerTable.end())
+        return it->second;
+
+    HashLifeNode node = {};
+    node.Children[0] = nw;
+    node.Children[1] = ne;
+    node.Children[2] = sw;
+    node.Children[3] = se;
+    node.ResultExponent = -1;
+    node.Level = nodes[nw].Level + 1;
+    node.Empty = nodes[nw].Empty && nodes[ne].Empty && nodes[sw].Empty && nodes[se].Empty;
+
+    uint32_t index = static_cast<uint32_t>(nodes.size());
+    nodes.push_back(node);
+    innerTable.emplace(key, index);
+    return index;
+}
+
+uint32_t HashLifeUniverse::EmptyNode(int level)
+{
+    if (static_cast<int>(emptyNodes.size()) <= level)
+        emptyNodes.resize(level + 1, 0);
+
+    if (!emptyNodes[level])
+    {
+        if (level == 3)
+        {
+            emptyNodes[level] = MakeLeaf(0);
+        }
+        else
+        {
+            uint32_t e = EmptyNode(level - 1);
+            emptyNodes[level] = Join(e, e, e, e);
+        }
+    }
+    return emptyNodes[level];
+}
+
+//
+// Evolution
+//
+
+// Centre half of a node, not advanced in time
+uint32_t HashLifeUniverse::Centre(uint32_t n)
+{
+    const uint32_t* c = nodes[n].Children;
+    uint32_t nw = c[0], ne = c[1], sw = c[2], se = c[3];
+
+    if (nodes[n].Level == 4)
+    {
+        uint16_t rows[16];
+        CombineLeaves(nodes[nw].Leaf, nodes[ne].Leaf, nodes[sw].Leaf, nodes[se].Leaf, rows);
+        return MakeLeaf(CentreLeaf(rows));
+    }
+
+    return Join(nodes[nw].Children[3], nodes[ne].Children[2], nodes[sw].Children[1], nodes[se].Children[0]);
+}
+
+// Level 4 (16x16) base case: the centre 8x8 after one (exponent 0) or two (exponent 1) generations
+uint32_t HashLifeUniverse::BaseResult(uint32_t n, int exponent)
+{
+    const uint32_t* c = nodes[n].Children;
+    uint16_t rows[16];
+    CombineLeaves(nodes[c[0]].Leaf, nodes[c[1]].Leaf, nodes[c[2]].Leaf, nodes[c[3]].Leaf, rows);
+
+    uint16_t once[16] = {};
+    StepBlock(rows, once, 2, *rule);
+    if (exponent == 0)
+        return MakeLeaf(CentreLeaf(once));
+
+    uint16_t twice[16] = {};
+    StepBlock(once, twice, 4, *rule);
+    return MakeLeaf(CentreLeaf(twice));
+}
+
+// Centre half of a level k node advanced 2^exponent generations, exponent <= k - 3
+uint32_t HashLifeUniverse::Result(uint32_t n, int exponent)
+{
+    int level = nodes[n].Level;
+
+    if (nodes[n].Empty)
+        return EmptyNode(level - 1);
+    if (nodes[n].Result && nodes[n].ResultExponent == exponent)
+        return nodes[n].Result;
+
+    uint32_t result;
+    if (level == 4)
+    {
+        result = BaseResult(n, exponent);
+    }
+    else
+    {
+        uint32_t a = nodes[n].Children[0], b = nodes[n].Children[1];
+        uint32_t c = nodes[n].Children[2], d = nodes[n].Children[3];
+
+        uint32_t A[4], B[4], C[4], D[4];
+        std::copy(nodes[a].Children, nodes[a].Children + 4, A);
+        std::copy(nodes[b].Children, nodes[b].Children + 4, B);
+        std::copy(nodes[c].Children, nodes[c].Children + 4, C);
+        std::copy(nodes[d].Children, nodes[d].Children + 4, D);
+
+        // Nine overlapping level k-1 nodes
+        uint32_t n00 = a;
+        uint32_t n01 = Join(A[1], B[0], A[3], B[2]);
+        uint32_t n02 = b;
+        uint32_t n10 = Join(A[2], A[3], C[0], C[1]);
+        uint32_t n11 = Join(A[3], B[2], C[1], D[0]);
+        uint32_t n12 = Join(B[2], B[3], D[0], D[1]);
+        uint32_t n20 = c;
+        uint32_t n21 = Join(C[1], D[0], C[3], D[2]);
+        uint32_t n22 = d;
+
+        // A full step splits the time between both halves; a shorter one leaves the first half still
+        bool full = exponent == level - 3;
+        auto FirstHalf = [&](uint32_t m) { return full ? Result(m, level - 4) : Centre(m); };
+
+        uint32_t r00 = FirstHalf(n00), r01 = FirstHalf(n01), r02 = FirstHalf(n02);
+        uint32_t r10 = FirstHalf(n10), r11 = FirstHalf(n11), r12 = FirstHalf(n12);
+        uint32_t r20 = FirstHalf(n20), r21 = FirstHalf(n21), r22 = FirstHalf(n22);
+
+        int secondExponent = full ? level - 4 : exponent;
+        uint32_t f00 = Result(Join(r00, r01, r10, r11), secondExponent);
+        uint32_t f01 = Result(Join(r01, r02, r11, r12), secondExponent);
+        uint32_t f10 = Result(Join(r10, r11, r20, r21), secondExponent);
+        uint32_t f11 = Result(Join(r11, r12, r21, r22), secondExponent);
+
+        result = Join(f00, f01, f10, f11);
+    }
+
+    nodes[n].Result = result;
+    nodes[n].ResultExponent = static_cast<int8_t>(exponent);
+    return result;
+}
+
+// Same pattern one level up, centred
+uint32_t HashLifeUniverse::Expand(uint32_t n)
+{
+    uint32_t e = EmptyNode(nodes[n].Level - 1);
+    uint32_t a = nodes[n].Children[0], b = nodes[n].Children[1];
+    uint32_t c = nodes[n].Children[2], d = nodes[n].Children[3];
+
+    return Join(Join(e, e, e, a), Join(e, e, b, e), Join(e, c, e, e), Join(d, e, e, e));
+}
+
+// True if everything lies in the centre half
+bool HashLifeUniverse::IsPadded(uint32_t n) const
+{
+    const uint32_t* c = nodes[n].Children;
+    for (int q = 0; q < 4; q++)
+    {
+        const uint32_t* g = nodes[c[q]].Children;
+        for (int i = 0; i < 4; i++)
+        {
+            if (i != 3 - q && !nodes[g[i]].Empty)
+                return false;
+        }
+    }
+    return true;
+}
+
+void HashLifeUniverse::Step(int exponent)
+{
+    // The pattern spreads 2^(exponent + 1) cells; expanding once more past the centre half puts it in the
+    // centre quarter, which leaves 2^(Level - 3) cells of room on each side of the result
+    while (nodes[root].Level < std::max(exponent + 3, HASHLIFE_MIN_LEVEL) || !IsPadded(root))
+        root = Expand(root);
+    root = Expand(root);
+
+    root = Result(root, exponent);
+
+    if (nodes.size() > HASHLIFE_MAX_NODES)
+    {
+        // Keep only the current tree; cached results are lost but rebuild quickly
+        std::vector<HashLifeNode> old;
+        old.swap(nodes);
+        uint32_t oldRoot = root;
+
+        nodes.push_back(HashLifeNode{});
+        innerTable.clear();
+        leafTable.clear();
+        emptyNodes.clear();
+
+        std::vector<uint32_t> remap(old.size(), 0);
+        std::function<uint32_t(uint32_t)> Copy = [&](uint32_t m) -> uint32_t {
+            if (remap[m])
+                return remap[m];
+            const HashLifeNode& node = old[m];
+            uint32_t copied = node.Level == 3 ? MakeLeaf(node.Leaf) :
+                Join(Copy(node.Children[0]), Copy(node.Children[1]), Copy(node.Children[2]), Copy(node.Children[3]));
+            remap[m] = copied;
+            return copied;
+        };
+        root = Copy(oldRoot);
+    }
+}
+
+//
+// Conversion to and from chunks
+//
+
+// Quadtree of a square block of chunk rows with its top-left at (x, y)
+uint32_t HashLifeUniverse::BuildBlock(const ChunkRows& rows, int level, int x, int y)
+{
+    if (level == 3)
+    {
+        uint64_t leaf = 0;
+        for (int r = 0; r < 8; r++)
+            leaf |= ((rows[y + r] >> (56 - x)) & 0xFF) << ((7 - r) * 8);
+        return MakeLeaf(leaf);
+    }
+
+    int half = 1 << (level - 1);
+    return Join(BuildBlock(rows, level - 1, x, y), BuildBlock(rows, level - 1, x + half, y),
+        BuildBlock(rows, level - 1, x, y + half), BuildBlock(rows, level - 1, x + half, y + half));
+}
+
+// OR a node's cells into chunk rows with its top-left at (x, y)
+void HashLifeUniverse::WriteBlock(uint32_t n, int x, int y, ChunkRows& rows) const
+{
+    const HashLifeNode& node = nodes[n];
+    if (node.Empty)
+        return;
+
+    if (node.Level == 3)
+    {
+        for (int r = 0; r < 8; r++)
+            rows[y + r] |= static_cast<uint64_t>(LeafRow(node.Leaf, r)) << (56 - x);
+        return;
+    }
+
+    int half = 1 << (node.Level - 1);
+    WriteBlock(node.Children[0], x, y, rows);
+    WriteBlock(node.Children[1], x + half, y, rows);
+    WriteBlock(node.Children[2], x, y + half, rows);
+    WriteBlock(node.Children[3], x + half, y + half, rows);
+}
+
+// Replace the block of level blockLevel at (x, y), relative to n's top-left
+uint32_t HashLifeUniverse::SetBlock(uint32_t n, int64_t x, int64_t y, uint32_t block, int blockLevel)
+{
+    int level = nodes[n].Level;
+    if (level == blockLevel)
+        return block;
+
+    int64_t half = int64_t(1) << (level - 1);
+    int q = (y >= half ? 2 : 0) + (x >= half ? 1 : 0);
+
+    uint32_t children[4];
+    std::copy(nodes[n].Children, nodes[n].Children + 4, children);
+    children[q] = SetBlock(children[q], x - (x >= half ? half : 0), y - (y >= half ? half : 0), block, blockLevel);
+
+    return Join(children[0], children[1], children[2], children[3]);
+}
+
+void HashLifeUniverse::Load(const ChunkMap& contents, uint8_t parity)
+{
+    root = EmptyNode(HASHLIFE_MIN_LEVEL);
+
+    for (const Chunk& chunk : contents)
+    {
+        if (chunk.Fill == 0)
+            continue;
+
+        int64_t x = static_cast<int64_t>(chunk.CoordinateX) * GRID_DIMENSIONS;
+        int64_t y = static_cast<int64_t>(chunk.CoordinateY) * GRID_DIMENSIONS;
+
+        // Grow the root until it covers the chunk
+        for (;;)
+        {
+            int64_t half = int64_t(1) << (nodes[root].Level - 1);
+            if (x >= -half && x + GRID_DIMENSIONS <= half && y >= -half && y + GRID_DIMENSIONS <= half)
+                break;
+            root = Expand(root);
+        }
+
+        int64_t half = int64_t(1) << (nodes[root].Level - 1);
+        root = SetBlock(root, x + half, y + half, BuildBlock(chunk.Rows(parity), 6, 0, 0), 6);
+    }
+}
+
+void HashLifeUniverse::StoreNode(uint32_t n, int64_t x, int64_t y, ChunkMap& contents) const
+{
+    const HashLifeNode& node = nodes[n];
+    if (node.Empty)
+        return;
+
+    if (node.Level == 6)
+    {
+        GridCoord coord = { static_cast<int>(x / GRID_DIMENSIONS), static_cast<int>(y / GRID_DIMENSIONS) };
+        Chunk& chunk = contents.Insert(coord);
+
+        ChunkRows rows = {};
+        WriteBlock(n, 0, 0, rows);
+        chunk.Buffers[0] = rows;
+        chunk.Buffers[1] = rows;
+
+        for (uint64_t row : rows)
+            chunk.Fill += PopCount64(row);
+        chunk.PreviousFill = chunk.Fill;
+        chunk.UpdateSummaries();
+        return;
+    }
+
+    int64_t half = int64_t(1) << (node.Level - 1);
+    StoreNode(node.Children[0], x, y, contents);
+    StoreNode(node.Children[1], x + half, y, contents);
+    StoreNode(node.Children[2], x, y + half, contents);
+    StoreNode(node.Children[3], x + half, y + half, contents);
+}
+
+void HashLifeUniverse::Store(ChunkMap& contents) const
+{
+    contents.Clear();
+
+    int64_t half = int64_t(1) << (nodes[root].Level - 1);
+    StoreNode(root, -half, -half, contents);
+}
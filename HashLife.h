@@ -0,0 +1,90 @@
+#pragma once
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+#include "ChunkMap.h"
+#include "OffsetStruct.h"
+
+// Nodes kept before the store is compacted down to the live tree
+#define HASHLIFE_MAX_NODES (1 << 22)
+
+// Smallest root level; level 7 (128 cells) keeps chunk boundaries on level-6 node boundaries
+#define HASHLIFE_MIN_LEVEL 7
+
+// Hash-consed quadtree node
+// Level 3 nodes are 8x8 leaves: row y in byte 7 - y, cell x at bit 7 - x of that byte (same order as chunk rows)
+// Higher levels have four children of the level below, covering 2^Level cells per side
+struct HashLifeNode {
+    uint32_t Children[4]; // NW, NE, SW, SE; unused for leaves
+    uint64_t Leaf;
+    uint32_t Result;      // Cached centre result, 0 = not computed
+    int8_t ResultExponent;
+    uint8_t Level;
+    bool Empty;
+};
+
+// Memoized quadtree (HashLife) engine for R2INT rules
+// A level k node's result is its centre 2^(k-1) square advanced up to 2^(k-3) generations:
+// range-2 rules spread 2 cells per generation, so that is as far as its own cells determine
+// Only rules without B0 are supported, since the quadtree assumes an empty background
+class HashLifeUniverse {
+public:
+    HashLifeUniverse();
+
+    // Drops every cached result if the rule (or its contents) changed since the last call
+    void SetRule(const R2INTRules& rules);
+
+    void Load(const ChunkMap& contents, uint8_t parity);
+    void Store(ChunkMap& contents) const;
+
+    // Advances the loaded pattern 2^exponent generations
+    void Step(int exponent);
+
+    size_t NodeCount() const { return nodes.size() - 1; }
+    int RootLevel() const { return nodes[root].Level; }
+
+    static bool SupportsRule(const R2INTRules& rules) { return !rules.Get(0); }
+
+private:
+    struct NodeKey {
+        uint32_t Children[4];
+        bool operator==(const NodeKey& other) const {
+            return Children[0] == other.Children[0] && Children[1] == other.Children[1] &&
+                Children[2] == other.Children[2] && Children[3] == other.Children[3];
+        }
+    };
+    struct NodeKeyHash {
+        std::size_t operator()(const NodeKey& key) const;
+    };
+    struct LeafHash {
+        std::size_t operator()(uint64_t leaf) const;
+    };
+
+    void Reset();
+
+    uint32_t MakeLeaf(uint64_t bits);
+    uint32_t Join(uint32_t nw, uint32_t ne, uint32_t sw, uint32_t se);
+    uint32_t EmptyNode(int level);
+
+    uint32_t Centre(uint32_t n);
+    uint32_t Result(uint32_t n, int exponent);
+    uint32_t BaseResult(uint32_t n, int exponent);
+
+    uint32_t Expand(uint32_t n);
+    bool IsPadded(uint32_t n) const;
+
+    uint32_t BuildBlock(const ChunkRows& rows, int level, int x, int y);
+    void WriteBlock(uint32_t n, int x, int y, ChunkRows& rows) const;
+    uint32_t SetBlock(uint32_t n, int64_t x, int64_t y, uint32_t block, int blockLevel);
+    void StoreNode(uint32_t n, int64_t x, int64_t y, ChunkMap& contents) const;
+
+    std::vector<HashLifeNode> nodes;
+    std::unordered_map<NodeKey, uint32_t, NodeKeyHash> innerTable;
+    std::unordered_map<uint64_t, uint32_t, LeafHash> leafTable;
+    std::vector<uint32_t> emptyNodes;
+
+    uint32_t root = 0; // Centred on the origin: covers -2^(Level-1) to 2^(Level-1) - 1 on both axes
+
+    const R2INTRules* rule = nullptr;
+    uint64_t ruleVersion = 0;
+};
@@ -0,0 +1,290 @@
+#include "IsotropicRules.h"
+#include "BitOps.h"
+#include "R2INT_File.h"
+#include "Symmetry.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+// Table words checked per ParallelFor index
+#define ISOTROPIC_MAP_BLOCK_WORDS 4096
+
+//
+// Isotropic class map
+//
+
+const IsotropicClassMap& IsotropicClassMap::Get()
+{
+    static const IsotropicClassMap map;
+    return map;
+}
+
+IsotropicClassMap::IsotropicClassMap()
+{
+    if (Map(ISOTROPIC_CLASS_FILE))
+        return;
+
+    Build();
+    Save(ISOTROPIC_CLASS_FILE); // Only a cache; failing to write it just means the next run builds again
+}
+
+// Payload layout: canonical bitmap, rank directory, representatives, padded to whole words
+static std::size_t PayloadWords(int classCount)
+{
+    std::size_t bytes = sizeof(uint64_t) * R2INTRules::WordCount + sizeof(uint32_t) * R2INTRules::WordCount +
+        sizeof(int32_t) * static_cast<std::size_t>(classCount);
+    return (bytes + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+}
+
+void IsotropicClassMap::Point(const uint64_t* payload, int count)
+{
+    CanonicalBits = payload;
+    RankBefore = reinterpret_cast<const uint32_t*>(payload + R2INTRules::WordCount);
+    Representatives = reinterpret_cast<const int32_t*>(RankBefore + R2INTRules::WordCount);
+    classCount = count;
+}
+
+bool IsotropicClassMap::Map(const std::string& path)
+{
+    if (!std::ifstream(path, std::ios::binary))
+        return false; // Not built yet
+
+    if (!file.Open(path))
+        return false;
+
+    IsotropicClassHeader header;
+    if (file.Size() < sizeof(header))
+    {
+        std::cerr << "Warning: " << path << " is too short to be a class map; rebuilding it.\n";
+        file.Close();
+        return false;
+    }
+    std::memcpy(&header, file.Data(), sizeof(header));
+
+    const std::size_t words = PayloadWords(header.ClassCount);
+    if (std::memcmp(header.Magic, "R2INTISO", sizeof(header.Magic)) != 0 || header.Version != ISOTROPIC_CLASS_VERSION ||
+        header.WordCount != static_cast<uint64_t>(R2INTRules::WordCount) ||
+        file.Size() < sizeof(header) + sizeof(uint64_t) * words)
+    {
+        std::cerr << "Warning: " << path << " is not a class map this program can use; rebuilding it.\n";
+        file.Close();
+        return false;
+    }
+
+    // Mappings are page-aligned and the header is 64 bytes, so the payload can be read in place
+    const uint64_t* payload = reinterpret_cast<const uint64_t*>(file.Data() + sizeof(header));
+    if (TableChecksum(payload, words) != header.Checksum)
+    {
+        std::cerr << "Warning: " << path << " failed its checksum; rebuilding it.\n";
+        file.Close();
+        return false;
+    }
+
+    Point(payload, static_cast<int>(header.ClassCount));
+    return true;
+}
+
+void IsotropicClassMap::Build()
+{
+    auto start = std::chrono::steady_clock::now();
+    std::cout << "Building isotropic class map..." << std::endl;
+
+    // A transition is canonical when none of its images is lower, which every word can check on its own
+    // (a private pool, since the shared one belongs to whichever thread is simulating)
+    std::vector<uint64_t> canonical(R2INTRules::WordCount, 0);
+    ThreadPool pool(ThreadPool::ResolveThreadCount(0));
+    pool.ParallelFor(R2INTRules::WordCount / ISOTROPIC_MAP_BLOCK_WORDS, [&canonical](int block) {
+        int end = (block + 1) * ISOTROPIC_MAP_BLOCK_WORDS;
+        for (int w = block * ISOTROPIC_MAP_BLOCK_WORDS; w < end; w++)
+        {
+            uint64_t bits = 0;
+            for (int b = 0; b < 64; b++)
+            {
+                if (IsCanonicalTransition(w * 64 + b))
+                    bits |= uint64_t(1) << b;
+            }
+            canonical[w] = bits;
+        }
+        });
+
+    int count = 0;
+    for (uint64_t bits : canonical)
+        count += PopCount64(bits);
+
+    built.assign(PayloadWords(count), 0);
+    std::copy(canonical.begin(), canonical.end(), built.begin());
+    Point(built.data(), count);
+
+    uint32_t* rankBefore = reinterpret_cast<uint32_t*>(built.data() + R2INTRules::WordCount);
+    int32_t* representatives = reinterpret_cast<int32_t*>(rankBefore + R2INTRules::WordCount);
+    uint32_t rank = 0;
+    for (int w = 0; w < R2INTRules::WordCount; w++)
+    {
+        rankBefore[w] = rank;
+        for (uint64_t bits = canonical[w]; bits; bits &= bits - 1)
+            representatives[rank++] = w * 64 + CountTrailingZeros64(bits);
+    }
+
+    auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start);
+    std::cout << "Isotropic class map complete (" << classCount << " classes, " << elapsed.count() << " ms)." << std::endl;
+}
+
+bool IsotropicClassMap::Save(const std::string& path) const
+{
+    std::ofstream outFile(path, std::ios::binary);
+    if (!outFile)
+    {
+        std::cerr << "Warning: Could not open " << path << " to cache the class map.\n";
+        return false;
+    }
+
+    IsotropicClassHeader header{};
+    std::memcpy(header.Magic, "R2INTISO", sizeof(header.Magic));
+    header.Version = ISOTROPIC_CLASS_VERSION;
+    header.ClassCount = static_cast<uint32_t>(classCount);
+    header.WordCount = R2INTRules::WordCount;
+    header.Checksum = TableChecksum(built.data(), built.size());
+
+    outFile.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    outFile.write(reinterpret_cast<const char*>(built.data()), sizeof(uint64_t) * built.size());
+    outFile.close();
+    if (!outFile)
+    {
+        std::cerr << "Warning: Could not write " << path << "; the class map will be rebuilt next time.\n";
+        return false;
+    }
+
+    std::cout << "Cached the isotropic class map in " << path << std::endl;
+    return true;
+}
+
+int IsotropicClassMap::RankOfCanonical(int Canonical) const
+{
+    uint64_t below = CanonicalBits[Canonical >> 6] & ((uint64_t(1) << (Canonical & 63)) - 1);
+    return static_cast<int>(RankBefore[Canonical >> 6]) + PopCount64(below);
+}
+
+int IsotropicClassMap::ClassOf(int Transition) const
+{
+    return RankOfCanonical(CanonicalTransition(Transition));
+}
+
+//
+// Class-keyed rule
+//
+
+IsotropicR2INTRules::IsotropicR2INTRules()
+    : Classes((IsotropicClassMap::Get().ClassCount() + 63) / 64, 0)
+{
+}
+
+void IsotropicR2INTRules::Set(int ClassId, bool Value)
+{
+    uint64_t mask = uint64_t(1) << (ClassId & 63);
+    if (Value) Classes[ClassId >> 6] |= mask;
+    else Classes[ClassId >> 6] &= ~mask;
+}
+
+void IsotropicR2INTRules::Toggle(int ClassId)
+{
+    Classes[ClassId >> 6] ^= uint64_t(1) << (ClassId & 63);
+}
+
+int IsotropicR2INTRules::CountSet() const
+{
+    int count = 0;
+    for (uint64_t word : Classes)
+        count += PopCount64(word);
+    return count;
+}
+
+void IsotropicR2INTRules::FromRaw(const R2INTRules& rules)
+{
+    const IsotropicClassMap& map = IsotropicClassMap::Get();
+    std::fill(Classes.begin(), Classes.end(), uint64_t(0));
+
+    for (int c = 0; c < map.ClassCount(); c++)
+    {
+        if (rules.Get(map.Representative(c)))
+            Classes[c >> 6] |= uint64_t(1) << (c & 63);
+    }
+}
+
+void IsotropicR2INTRules::ExpandTo(R2INTRules& rules) const
+{
+    const IsotropicClassMap& map = IsotropicClassMap::Get();
+
+    // Written word by word like the other bulk fills, so the version only moves once
+    std::fill(rules.R2MAP.begin(), rules.R2MAP.end(), uint64_t(0));
+    uint64_t* words = rules.R2MAP.data();
+    for (int w = 0; w < static_cast<int>(Classes.size()); w++)
+    {
+        for (uint64_t word = Classes[w]; word; word &= word - 1)
+        {
+            int c = w * 64 + CountTrailingZeros64(word);
+            for (int s : TransitionSymmetries(map.Representative(c)))
+                words[s >> 6] |= uint64_t(1) << (s & 63);
+        }
+    }
+    rules.Version++;
+}
+
+std::vector<int> IsotropicR2INTRules::Diff(const IsotropicR2INTRules& other) const
+{
+    std::vector<int> changed;
+
+    for (int w = 0; w < static_cast<int>(Classes.size()); w++)
+    {
+        uint64_t word = Classes[w] ^ other.Classes[w];
+        while (word)
+        {
+            changed.push_back(w * 64 + CountTrailingZeros64(word));
+            word &= word - 1;
+        }
+    }
+
+    return changed;
+}
+
+std::vector<int> IsotropicR2INTRules::Mutate(std::mt19937& gen, int Count)
+{
+    std::uniform_int_distribution<int> pick(0, IsotropicClassMap::Get().ClassCount() - 1);
+    std::vector<int> flipped;
+    flipped.reserve(Count);
+
+    for (int i = 0; i < Count; i++)
+    {
+        int c = pick(gen);
+        Toggle(c);
+        flipped.push_back(c);
+    }
+
+    return flipped;
+}
+
+void IsotropicR2INTRules::Randomize(std::mt19937& gen)
+{
+    std::uniform_int_distribution<uint64_t> bits;
+    for (uint64_t& word : Classes)
+        word = bits(gen);
+
+    // Ids past the last class stay off, so CountSet and Diff never see them
+    int tail = IsotropicClassMap::Get().ClassCount() & 63;
+    if (tail)
+        Classes.back() &= (uint64_t(1) << tail) - 1;
+}
+
+void MutateRule(R2INTRules& rules, std::mt19937& gen, int Count)
+{
+    const IsotropicClassMap& map = IsotropicClassMap::Get();
+    std::uniform_int_distribution<int> pick(0, map.ClassCount() - 1);
+
+    for (int i = 0; i < Count; i++)
+    {
+        int c = pick(gen);
+        rules.ToggleIsotropicTransition(ConvertIntToNeighborhood(map.Representative(c)));
+    }
+}
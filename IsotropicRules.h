@@ -0,0 +1,101 @@
+#pragma once
+
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+#include "MappedFile.h"
+#include "OffsetStruct.h"
+
+// The class map is built once and cached in this file, which later runs memory-map instead of rebuilding
+// (a cache for this machine, not an exchange format; a missing, stale or corrupt file is simply rebuilt)
+#define ISOTROPIC_CLASS_FILE "IsotropicClasses.bin"
+#define ISOTROPIC_CLASS_VERSION 1
+
+// Followed by the canonical bitmap (WordCount words), the rank directory (WordCount uint32) and the representatives
+// (ClassCount int32), padded to whole words; Checksum covers all of it
+struct IsotropicClassHeader {
+    char Magic[8];         // "R2INTISO"
+    uint32_t Version;      // ISOTROPIC_CLASS_VERSION of the writer
+    uint32_t ClassCount;
+    uint64_t WordCount;    // R2INTRules::WordCount
+    uint64_t Checksum;     // FNV-1a over the words after the header
+    uint8_t Reserved[32];  // Zero
+};
+static_assert(sizeof(IsotropicClassHeader) == 64, "IsotropicClassHeader is part of the cache format");
+
+// Numbers every isotropic class of the 2^25 raw transitions (~4.2M classes)
+// A class is represented by its lowest raw transition, and class ids are handed out in that order
+// Raw -> class goes through a rank over the canonical bitmap
+class IsotropicClassMap {
+public:
+    static const IsotropicClassMap& Get();
+
+    IsotropicClassMap(const IsotropicClassMap&) = delete;
+    IsotropicClassMap& operator=(const IsotropicClassMap&) = delete;
+
+    int ClassCount() const { return classCount; }
+
+    bool IsCanonical(int Transition) const {
+        return (CanonicalBits[Transition >> 6] >> (Transition & 63)) & 1;
+    }
+
+    // Canonical transitions of table word WordIndex, in the same bit layout as R2INTRules::GetWord
+    uint64_t CanonicalWord(int WordIndex) const { return CanonicalBits[WordIndex]; }
+
+    int ClassOf(int Transition) const;          // Raw transition -> class id
+    int RankOfCanonical(int Canonical) const;   // Same, for a transition that is already canonical
+    int Representative(int ClassId) const { return Representatives[ClassId]; }
+
+private:
+    IsotropicClassMap();
+
+    bool Map(const std::string& path); // Points into a valid cache file; false if it is missing or unusable
+    void Build();
+    bool Save(const std::string& path) const;
+    void Point(const uint64_t* payload, int count);
+
+    MappedFile file;
+    std::vector<uint64_t> built; // The payload, when it was built rather than mapped
+
+    const uint64_t* CanonicalBits = nullptr;   // Bit set for the lowest transition of each class
+    const uint32_t* RankBefore = nullptr;      // Number of canonical transitions before each word
+    const int32_t* Representatives = nullptr;  // Class id -> lowest raw transition
+    int classCount = 0;
+};
+
+// R2INT rule keyed by isotropic class id, one bit per class (~512 KB)
+// The raw R2INTRules table is still what the simulation reads; use ExpandTo to build it
+class IsotropicR2INTRules {
+public:
+    IsotropicR2INTRules();
+
+    bool Get(int ClassId) const {
+        return (Classes[ClassId >> 6] >> (ClassId & 63)) & 1;
+    }
+    void Set(int ClassId, bool Value);
+    void Toggle(int ClassId);
+
+    int CountSet() const;
+
+    // Conversion to and from the raw table; FromRaw reads each class at its representative
+    void FromRaw(const R2INTRules& rules);
+    void ExpandTo(R2INTRules& rules) const;
+
+    // Class ids whose transitions differ between the two rules
+    std::vector<int> Diff(const IsotropicR2INTRules& other) const;
+
+    // Flip Count random classes; returns the class ids that were flipped
+    std::vector<int> Mutate(std::mt19937& gen, int Count);
+
+    // Turn each class on with even odds
+    void Randomize(std::mt19937& gen);
+
+    bool operator==(const IsotropicR2INTRules& rhs) const { return Classes == rhs.Classes; }
+    bool operator!=(const IsotropicR2INTRules& rhs) const { return Classes != rhs.Classes; }
+
+    std::vector<uint64_t> Classes;
+};
+
+// Flip Count random isotropic classes directly in a raw table
+void MutateRule(R2INTRules& rules, std::mt19937& gen, int Count);
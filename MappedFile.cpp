@@ -0,0 +1,123 @@
+#include "MappedFile.h"
+#include <iostream>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::~MappedFile()
+{
+    Close();
+}
+
+#ifdef _WIN32
+bool MappedFile::Open(const std::string& path)
+{
+    Close();
+
+    HANDLE f = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (f == INVALID_HANDLE_VALUE)
+    {
+        std::cerr << "Error: Could not open " << path << " for reading.\n";
+        return false;
+    }
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(f, &fileSize))
+    {
+        std::cerr << "Error: Could not read the size of " << path << ".\n";
+        CloseHandle(f);
+        return false;
+    }
+    if (fileSize.QuadPart == 0)
+    {
+        CloseHandle(f); // Empty files can't be mapped, and don't need to be
+        return true;
+    }
+
+    HANDLE m = CreateFileMappingA(f, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    const void* view = m ? MapViewOfFile(m, FILE_MAP_READ, 0, 0, 0) : nullptr;
+    if (!view)
+    {
+        std::cerr << "Error: Could not map " << path << ".\n";
+        if (m)
+            CloseHandle(m);
+        CloseHandle(f);
+        return false;
+    }
+
+    file = f;
+    mapping = m;
+    data = static_cast<const uint8_t*>(view);
+    size = static_cast<std::size_t>(fileSize.QuadPart);
+    return true;
+}
+
+void MappedFile::Close()
+{
+    if (data)
+        UnmapViewOfFile(data);
+    if (mapping)
+        CloseHandle(mapping);
+    if (file)
+        CloseHandle(file);
+
+    data = nullptr;
+    size = 0;
+    mapping = nullptr;
+    file = nullptr;
+}
+#else
+bool MappedFile::Open(const std::string& path)
+{
+    Close();
+
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        std::cerr << "Error: Could not open " << path << " for reading.\n";
+        return false;
+    }
+
+    struct stat info;
+    if (fstat(fd, &info) != 0)
+    {
+        std::cerr << "Error: Could not read the size of " << path << ".\n";
+        close(fd);
+        return false;
+    }
+    if (info.st_size == 0)
+    {
+        close(fd); // Empty files can't be mapped, and don't need to be
+        return true;
+    }
+
+    void* view = mmap(nullptr, static_cast<std::size_t>(info.st_size), PROT_READ, MAP_SHARED, fd, 0);
+    close(fd); // The mapping keeps the file alive
+    if (view == MAP_FAILED)
+    {
+        std::cerr << "Error: Could not map " << path << ".\n";
+        return false;
+    }
+
+    data = static_cast<const uint8_t*>(view);
+    size = static_cast<std::size_t>(info.st_size);
+    return true;
+}
+
+void MappedFile::Close()
+{
+    if (data)
+        munmap(const_cast<uint8_t*>(data), size);
+
+    data = nullptr;
+    size = 0;
+}
+#endif
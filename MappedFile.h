@@ -0,0 +1,30 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Read-only memory mapping of a whole file
+// Pages are only read in as they are touched, so opening is instant whatever the file size
+class MappedFile {
+public:
+    MappedFile() = default;
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool Open(const std::string& path); // Prints the reason and returns false on failure; empty files map to no data
+    void Close();
+
+    const uint8_t* Data() const { return data; }
+    std::size_t Size() const { return size; }
+
+private:
+    const uint8_t* data = nullptr;
+    std::size_t size = 0;
+
+#ifdef _WIN32
+    void* file = nullptr;    // HANDLE
+    void* mapping = nullptr; // HANDLE
+#endif
+};
@@ -1,4 +1,5 @@
 #include "OffsetStruct.h"
+#include "Symmetry.h"
 #include <cstddef>
 #include <cstdint>
 #include <iostream>
@@ -9,77 +10,40 @@
 // Code to manipulate Neighborhoods
 //
 
-inline Neighborhood RotateNeighborhoodCW(const Neighborhood& lhs)
+// These round-trip through the packed transition; see Symmetry.h
+Neighborhood RotateNeighborhoodCW(const Neighborhood& lhs)
 {
-	Neighborhood ret = {
-		lhs[20], lhs[15], lhs[10], lhs[5], lhs[0],
-		lhs[21], lhs[16], lhs[11], lhs[6], lhs[1],
-		lhs[22], lhs[17], lhs[12], lhs[7], lhs[2],
-		lhs[23], lhs[18], lhs[13], lhs[8], lhs[3],
-		lhs[24], lhs[19], lhs[14], lhs[9], lhs[4]
-	};
-
-	return ret;
+	return ConvertIntToNeighborhood(RotateTransitionCW(ConvertNeighborhoodToInt(lhs)));
 }
 
-inline Neighborhood RotateNeighborhoodCCW(const Neighborhood& lhs)
+Neighborhood RotateNeighborhoodCCW(const Neighborhood& lhs)
 {
-    Neighborhood ret = {
-        lhs[4], lhs[9], lhs[14], lhs[19], lhs[24],
-        lhs[3], lhs[8], lhs[13], lhs[18], lhs[23],
-        lhs[2], lhs[7], lhs[12], lhs[17], lhs[22],
-        lhs[1], lhs[6], lhs[11], lhs[16], lhs[21],
-        lhs[0], lhs[5], lhs[10], lhs[15], lhs[20]
-    };
-
-    return ret;
+	return ConvertIntToNeighborhood(RotateTransitionCCW(ConvertNeighborhoodToInt(lhs)));
 }
 
-inline Neighborhood MirrorNeighborhoodHorizontally(const Neighborhood& lhs)
+Neighborhood MirrorNeighborhoodHorizontally(const Neighborhood& lhs)
 {
-	Neighborhood ret = {
-		lhs[4],  lhs[3],  lhs[2],  lhs[1],  lhs[0],
-		lhs[9],  lhs[8],  lhs[7],  lhs[6],  lhs[5],
-		lhs[14], lhs[13], lhs[12], lhs[11], lhs[10],
-		lhs[19], lhs[18], lhs[17], lhs[16], lhs[15],
-		lhs[24], lhs[23], lhs[22], lhs[21], lhs[20]
-	};
-
-	return ret;
+	return ConvertIntToNeighborhood(MirrorTransitionHorizontally(ConvertNeighborhoodToInt(lhs)));
 }
 
-inline Neighborhood MirrorNeighborhoodVertically(const Neighborhood& lhs)
+Neighborhood MirrorNeighborhoodVertically(const Neighborhood& lhs)
 {
-	Neighborhood ret = {
-		lhs[20], lhs[21], lhs[22], lhs[23], lhs[24],
-		lhs[15], lhs[16], lhs[17], lhs[18], lhs[19],
-		lhs[10], lhs[11], lhs[12], lhs[13], lhs[14],
-		lhs[5],  lhs[6],  lhs[7],  lhs[8],  lhs[9],
-		lhs[0],  lhs[1],  lhs[2],  lhs[3],  lhs[4]
-	};
-
-	return ret;
+	return ConvertIntToNeighborhood(MirrorTransitionVertically(ConvertNeighborhoodToInt(lhs)));
 }
 
-// Generate all 8 rotations and reflections of a neighborhood
+// Generate all 8 rotations and reflections of a neighborhood:
+// r0, CW, CCW, 180, then the horizontal mirror of each
 std::vector<Neighborhood> GetAllSymmetries(const Neighborhood& n)
 {
-    std::vector<Neighborhood> result;
-    result.reserve(8);
-
-    // Base rotations
-    Neighborhood r0 = n;
-    Neighborhood r1 = RotateNeighborhoodCW(r0);
-    Neighborhood r2 = RotateNeighborhoodCCW(r0);
-    Neighborhood r3 = RotateNeighborhoodCW(r1);
+    // TransitionSymmetries gives the counterclockwise rotations (r0, CCW, 180, CW), then those of the mirror
+    static constexpr int Order[8] = { 0, 3, 1, 2, 4, 5, 7, 6 };
 
-    // Reflections of each rotation (horizontal mirror)
-    Neighborhood f0 = MirrorNeighborhoodHorizontally(r0);
-    Neighborhood f1 = MirrorNeighborhoodHorizontally(r1);
-    Neighborhood f2 = MirrorNeighborhoodHorizontally(r2);
-    Neighborhood f3 = MirrorNeighborhoodHorizontally(r3);
+    std::array<int, 8> transitions = TransitionSymmetries(ConvertNeighborhoodToInt(n));
 
-    result = { r0, r1, r2, r3, f0, f1, f2, f3 };
+    std::vector<Neighborhood> result;
+    result.reserve(8);
+    for (int i : Order)
+        result.push_back(ConvertIntToNeighborhood(transitions[i]));
     return result;
 }
 
@@ -187,66 +151,22 @@ int8_t Neighborhood::countTotalCells() const
 // Isotropic counting functions
 int FindLowestNeighborhoodValue(Neighborhood EvalNeighborhood)
 {
-	int SmallestNumber = ConvertNeighborhoodToInt(EvalNeighborhood);
-	Neighborhood ReduceTest = EvalNeighborhood;
-
-	for (int i = 0; i < 4; i++)
-	{
-		ReduceTest = RotateNeighborhoodCCW(ReduceTest);
-
-		int CompareResult = ConvertNeighborhoodToInt(ReduceTest);
-		if (SmallestNumber > CompareResult)
-			SmallestNumber = CompareResult;
-	}
-
-	ReduceTest = MirrorNeighborhoodHorizontally(EvalNeighborhood);
-
-	for (int i = 0; i < 4; i++)
-	{
-		ReduceTest = RotateNeighborhoodCCW(ReduceTest);
-
-		int CompareResult = ConvertNeighborhoodToInt(ReduceTest);
-		if (SmallestNumber > CompareResult)
-			SmallestNumber = CompareResult;
-	}
-
-	return SmallestNumber;
+	return CanonicalTransition(ConvertNeighborhoodToInt(EvalNeighborhood));
 }
 
 int FindLowestNeighborhoodValue(int EvalNumber)
 {
-	Neighborhood EvalResult = ConvertIntToNeighborhood(EvalNumber);
-
-	return FindLowestNeighborhoodValue(EvalResult);
+	return CanonicalTransition(EvalNumber);
 }
 
 std::array<int, 8> FindAllIsotropicNeighborhoodValues(Neighborhood EvalNeighborhood)
 {
-	std::array<int, 8> ret = {};
-	Neighborhood IsotropicTest = EvalNeighborhood;
-
-	for (int i = 0; i < 4; i++)
-	{
-		ret[i] = ConvertNeighborhoodToInt(IsotropicTest);
-		IsotropicTest = RotateNeighborhoodCCW(IsotropicTest);
-	}
-
-	IsotropicTest = MirrorNeighborhoodHorizontally(EvalNeighborhood);
-
-	for (int i = 0; i < 4; i++)
-	{
-		ret[i+4] = ConvertNeighborhoodToInt(IsotropicTest);
-		IsotropicTest = RotateNeighborhoodCCW(IsotropicTest);
-	}
-
-	return ret;
+	return TransitionSymmetries(ConvertNeighborhoodToInt(EvalNeighborhood));
 }
 
 std::array<int, 8> FindAllIsotropicNeighborhoodValues(int EvalNumber)
 {
-	Neighborhood EvalResult = ConvertIntToNeighborhood(EvalNumber);
-
-	return FindAllIsotropicNeighborhoodValues(EvalResult);
+	return TransitionSymmetries(EvalNumber);
 }
 
 bool ApplyRules(int Transition, const R2INTRules& rules) {
@@ -254,7 +174,7 @@ bool ApplyRules(int Transition, const R2INTRules& rules) {
 	{
 		return false; // Modify if the CA becomes bugged
 	}
-	return rules.R2MAP[Transition];
+	return rules.Get(Transition);
 }
 
 bool ApplyRules(Neighborhood Transition, const R2INTRules& rules) {
@@ -263,34 +183,38 @@ bool ApplyRules(Neighborhood Transition, const R2INTRules& rules) {
 
 void R2INTRules::ToggleIsotropicTransition(Neighborhood n)
 {
-	int newTransition = 1 - R2MAP[ConvertNeighborhoodToInt(n)];
-	for (int i = 0; i < 4; i++)
-	{
-		int t = ConvertNeighborhoodToInt(n);
-		R2MAP[t] = newTransition;
-		n = RotateNeighborhoodCW(n);
-	}
-
-	n = MirrorNeighborhoodVertically(n);
-
-	for (int i = 0; i < 4; i++)
-	{
-		int t = ConvertNeighborhoodToInt(n);
-		R2MAP[t] = newTransition;
-		n = RotateNeighborhoodCW(n);
-	}
+	int t = ConvertNeighborhoodToInt(n);
+	bool newTransition = !Get(t);
+	for (int s : TransitionSymmetries(t))
+		Set(s, newTransition);
 }
 
 void R2INTRules::ClearRule()
 {
     std::cout << "Clearing rule..." << std::endl;
-    for (unsigned int i = 0; i < 33554432; i++)
+    Fill(false);
+}
+
+void R2INTRules::Fill(bool Value)
+{
+    Version++;
+    std::fill(R2MAP.begin(), R2MAP.end(), Value ? ~uint64_t(0) : uint64_t(0));
+}
+
+void R2INTRules::CopyFrom(const R2INTRules& rhs)
+{
+    Version++;
+    std::copy(rhs.R2MAP.begin(), rhs.R2MAP.end(), R2MAP.begin());
+}
+
+// FNV-1a over the packed words, so rules can be compared or cached cheaply
+std::size_t R2INTRules::Hash() const
+{
+    uint64_t hash = 14695981039346656037ull;
+    for (uint64_t word : R2MAP)
     {
-        Neighborhood n = ConvertIntToNeighborhood(i);
-        R2MAP[i] = 0;
-        if (i % PERCENT_INCREMENT == PERCENT_INCREMENT - 1)
-        {
-            std::cout << (i * 100 + 100) / 33554432 << "% complete." << std::endl;
-        }
+        hash ^= word;
+        hash *= 1099511628211ull;
     }
+    return static_cast<std::size_t>(hash ^ (hash >> 32));
 }
\ No newline at end of file
@@ -1,15 +1,11 @@
 #pragma once
 
 #include <array>
+#include <cstddef>
 #include <cstdint>
+#include <iterator>
 #include <vector>
 
-#ifdef _DEBUG
-#define PERCENT_INCREMENT 2097152
-#else
-#define PERCENT_INCREMENT 8388608
-#endif
-
 struct OffsetInfo {
 	int CellXOffset;
 	int CellYOffset;
@@ -25,7 +21,7 @@ struct SymmetryInfo {
 
 struct Neighborhood {
 	void operator=(const Neighborhood& rhs) {
-		for (int i = 0; i < _countof(ArrayStorage); i++)
+		for (int i = 0; i < static_cast<int>(std::size(ArrayStorage)); i++)
 			ArrayStorage[i] = rhs.ArrayStorage[i];
 	}
 
@@ -49,20 +45,69 @@ struct Neighborhood {
 };
 
 // R2INT rule data structure
-// Data is stored in a non-isotropic table
+// Data is stored in a non-isotropic table, packed one bit per transition
+// (word i holds transitions 64 * i to 64 * i + 63, lowest bit first)
 class R2INTRules {
 public:
-	bool R2MAP[33554432] = { false };
+	static constexpr int TransitionCount = 33554432;
+	static constexpr int WordCount = TransitionCount / 64;
+
+	// Single bits can't be referenced, so the non-const operator[] hands out this proxy
+	class BitReference {
+	public:
+		BitReference(uint64_t& word, uint64_t mask, uint64_t& version) : Word(word), Mask(mask), Version(version) {}
+
+		operator bool() const { return (Word & Mask) != 0; }
+
+		BitReference& operator=(bool Value) {
+			Version++;
+			if (Value) Word |= Mask;
+			else Word &= ~Mask;
+			return *this;
+		}
+
+		BitReference& operator=(const BitReference& rhs) {
+			return *this = static_cast<bool>(rhs);
+		}
+
+	private:
+		uint64_t& Word;
+		uint64_t Mask;
+		uint64_t& Version;
+	};
+
+	R2INTRules() : R2MAP(WordCount, 0) {}
+
+	std::vector<uint64_t> R2MAP;
+	uint64_t Version = 0; // Bumped by every write, so worlds can tell when the rule was edited
 	void ToggleIsotropicTransition(Neighborhood n);
     void ClearRule();
 
-	bool& operator[](int Index) {  // Now returns a modifiable reference
-		return R2MAP[Index];
+    // Bulk word-level operations
+    uint64_t GetWord(int WordIndex) const { return R2MAP[WordIndex]; }
+    void SetWord(int WordIndex, uint64_t Value) { Version++; R2MAP[WordIndex] = Value; }
+    void Fill(bool Value);
+    void CopyFrom(const R2INTRules& rhs);
+    std::size_t Hash() const;
+
+    bool Get(int Index) const {
+        return (R2MAP[Index >> 6] >> (Index & 63)) & 1;
+    }
+
+    void Set(int Index, bool Value) {
+        (*this)[Index] = Value;
+    }
+
+	BitReference operator[](int Index) {  // Returns a modifiable proxy for the bit; reading through it isn't an edit
+		return BitReference(R2MAP[Index >> 6], uint64_t(1) << (Index & 63), Version);
 	}
 
-    const bool& operator[](int index) const {
-        return R2MAP[index];
+    bool operator[](int index) const {
+        return Get(index);
     }
+
+    bool operator==(const R2INTRules& rhs) const { return R2MAP == rhs.R2MAP; }
+    bool operator!=(const R2INTRules& rhs) const { return R2MAP != rhs.R2MAP; }
 };
 
 // Rotation functions
@@ -75,8 +120,8 @@ std::vector<Neighborhood> GetAllSymmetries(const Neighborhood& n);
 Neighborhood ShiftNeighborhood(const Neighborhood& lhs, int dx, int dy);
 // Conversion functions
 int ConvertNeighborhoodToInt(const Neighborhood& EvalVector);
-inline Neighborhood ConvertIntToNeighborhood(int EvalNumber);
-// Isotropic rule functions
+Neighborhood ConvertIntToNeighborhood(int EvalNumber);
+// Isotropic rule functions (see Symmetry.h for the packed versions these wrap)
 int FindLowestNeighborhoodValue(int EvalNumber);
 int FindLowestNeighborhoodValue(Neighborhood EvalNeighborhood);
 std::array<int, 8> FindAllIsotropicNeighborhoodValues(int EvalNumber);
@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <array>
 #include <filesystem>
 #include <iostream>
@@ -6,8 +7,11 @@
 #include <string>
 
 #include "World.h"
+#include "ChunkRenderer.h"
+#include "SimulationThread.h"
 #include "OffsetStruct.h"
 #include "R2INT_File.h"
+#include "RuleCompiler.h"
 #include "RuleEditor.h"
 #include "gui.h"
 
@@ -15,51 +19,24 @@ R2INTRules globalRule;
 
 void InitializeRule()
 {
-    std::cout << "Initializing rule..." << std::endl;
-
-    std::random_device rd;
-    std::mt19937 gen(rd());
-    std::uniform_int_distribution<int> rnd(0, 6);
-
-    for (unsigned int i = 0; i < 33554432; i++)
-    {
-        Neighborhood n = ConvertIntToNeighborhood(i);
-        globalRule[i] = 0;
-        // Conway's Game of Life (B3/S23)
-        int8_t neighbors = n[6] + n[7] + n[8] + n[11] + n[13] + n[16] + n[17] + n[18];
-        if (n[12] == 0)
-        {
-            // Dead
-            if (neighbors == 3)
-            {
-                globalRule[i] = 1;
-            }
-        }
-        else
-        {
-            // Alive
-            if (neighbors == 2 || neighbors == 3)
-            {
-                globalRule[i] = 1;
-            }
-        }
-
-        if (i % PERCENT_INCREMENT == PERCENT_INCREMENT - 1)
-        {
-            std::cout << (i * 100 + 100) / 33554432 << "% complete." << std::endl;
-        }
-    }
-
-    std::cout << "Initializing rule complete." << std::endl;
+    // Conway's Game of Life (B3/S23)
+    CompileRulestring("B3/S23", globalRule);
 }
 
 int main() {
     InitializeRule();
     std::cout << "Initializing grid..." << std::endl;
-    World currentWorld;
-    World originalWorld = currentWorld;
+    World originalWorld;
     std::cout << "Initialize grid complete!" << std::endl;
 
+    // The simulation runs on its own thread; currentWorld is its latest snapshot, refreshed every frame
+    SimulationThread simulation(originalWorld, globalRule);
+    std::shared_ptr<const World> currentWorld = simulation.Snapshot();
+    uint64_t postedRuleVersion = globalRule.Version;
+    int engine = ENGINE_CHUNKS;
+    int stepExponent = 0; // Each step advances 2^stepExponent generations
+    bool maxSpeed = false;
+
     // Load font
     sf::Font font;
     if (!font.openFromFile("assets\\arial.ttf")) {
@@ -73,6 +50,11 @@ int main() {
 
     RuleEditor ruleEditor(gen, font, globalRule);
 
+    // Generation and speed readout in the top-left corner
+    sf::Text statusText(font, "", 20);
+    statusText.setPosition({ 16.f, 16.f });
+    statusText.setFillColor(sf::Color(128, 255, 192));
+
     //
     // Playback variables
     //
@@ -80,7 +62,6 @@ int main() {
 
     // Timer variables
     float timeStep = 1.0f / 60.0f;  // 60 updates per second
-    float accumulator = 0.0f;
     sf::Clock clock;
     int frameCount = 0;
     float elapsedTime = 0.0f;
@@ -104,6 +85,7 @@ int main() {
     ruleEditorColors[3] = sf::Color::Color(224, 64, 240);
 
     sf::RenderWindow window(sf::VideoMode({ 1024, 768 }), "R2INT");
+    ChunkRenderer chunkRenderer;
     std::unique_ptr<sf::RenderWindow> secondWindow = nullptr;
     window.setFramerateLimit(60);
 
@@ -141,14 +123,16 @@ int main() {
     // Make the callbacks for the main GUI buttons
     auto PlayPause = [&]() {
         isPlaying = !isPlaying;
+        simulation.SetPlaying(isPlaying);
         sf::Color playColor = isPlaying ? sf::Color(0, 192, 96) : sf::Color(0, 255, 128);
         sf::Texture& texture = isPlaying ? mainGui.pauseTex : mainGui.playTex;
         mainGui.playButton.setColor(playColor);
         mainGui.playButton.SetIcon(texture);
         };
     auto Reset = [&]() {
-        currentWorld = originalWorld;
+        simulation.ReplaceWorld(originalWorld);
         isPlaying = false;
+        simulation.SetPlaying(false);
         mainGui.playButton.setColor(sf::Color(0, 255, 128));
         mainGui.playButton.SetIcon(mainGui.playTex);
         };
@@ -167,23 +151,25 @@ int main() {
         menuManager.Open("Patterns");
         };
     auto ClearPattern = [&]() {
-        currentWorld = World();
-        originalWorld = currentWorld;
+        originalWorld = World();
+        simulation.ReplaceWorld(originalWorld);
         isPlaying = false;
+        simulation.SetPlaying(false);
         mainGui.playButton.setColor(sf::Color(0, 255, 128));
         mainGui.playButton.SetIcon(mainGui.playTex);
         menuManager.Close();
         };
     auto Randomize = [&]() {
-        currentWorld.TestRandomize();
-        originalWorld = currentWorld;
+        originalWorld.TestRandomize();
+        simulation.ReplaceWorld(originalWorld);
         isPlaying = false;
+        simulation.SetPlaying(false);
         mainGui.playButton.setColor(sf::Color(0, 255, 128));
         mainGui.playButton.SetIcon(mainGui.playTex);
         menuManager.Close();
         };
     auto SavePattern = [&]() {
-        currentWorld.PrintRLE();
+        currentWorld->PrintRLE();
         };
     mainGui.playButton.SetCallback(PlayPause);
     mainGui.resetButton.SetCallback(Reset);
@@ -199,6 +185,8 @@ int main() {
     menuManager.AddMenu("Patterns", std::move(patternMenu));
 
     while (window.isOpen()) {  // Replace `mainWindow` with `window`
+        currentWorld = simulation.Snapshot();
+
         while (const std::optional event = window.pollEvent()) {  // Use `window` for event polling
             if (event->is<sf::Event::Closed>()) {
                 window.close();
@@ -217,8 +205,8 @@ int main() {
                     sf::Vector2i pixelPos = sf::Mouse::getPosition(window);
                     sf::Vector2f mouseWorldPos = window.mapPixelToCoords(pixelPos, view);
 
-                    sf::Vector2i pos = currentWorld.GetWorldCoords(mouseWorldPos);
-                    drawingState = (currentWorld.GetCellStateAt(pos) + 1) % currentWorld.n_states;
+                    sf::Vector2i pos = currentWorld->GetWorldCoords(mouseWorldPos);
+                    drawingState = (currentWorld->GetCellStateAt(pos) + 1) % currentWorld->n_states;
                 }
                 else if (event->getIf<sf::Event::MouseButtonPressed>()->button == sf::Mouse::Button::Left)
                 {
@@ -254,6 +242,7 @@ int main() {
                     if (sf::Keyboard::isKeyPressed(sf::Keyboard::Key::LShift) ||
                         sf::Keyboard::isKeyPressed(sf::Keyboard::Key::RShift)) {
                         timeStep /= 1.18920711f; // Keep this
+                        simulation.SetTimeStep(timeStep);
                     }
                     else {
                         view.zoom(0.5f); // Zoom IN (scale down view size)
@@ -264,6 +253,7 @@ int main() {
                     if (sf::Keyboard::isKeyPressed(sf::Keyboard::Key::LShift) ||
                         sf::Keyboard::isKeyPressed(sf::Keyboard::Key::RShift)) {
                         timeStep *= 1.18920711f; // Keep this
+                        simulation.SetTimeStep(timeStep);
                     }
                     else {
                         view.zoom(2.0f); // Zoom OUT (scale up view size)
@@ -275,8 +265,26 @@ int main() {
                 }
                 else if (keyPress == sf::Keyboard::Key::Space)
                 {
-                    accumulator += timeStep;
+                    simulation.Step();
                     isPlaying = false;
+                    simulation.SetPlaying(false);
+                }
+                else if (keyPress == sf::Keyboard::Key::H)
+                {
+                    engine = engine == ENGINE_HASHLIFE ? ENGINE_CHUNKS : ENGINE_HASHLIFE;
+                    simulation.Post([engine](World& w) { w.Engine = engine; });
+                    std::cout << (engine == ENGINE_HASHLIFE ? "HashLife" : "Chunk") << " engine" << std::endl;
+                }
+                else if (keyPress == sf::Keyboard::Key::LBracket || keyPress == sf::Keyboard::Key::RBracket)
+                {
+                    stepExponent += keyPress == sf::Keyboard::Key::RBracket ? 1 : -1;
+                    stepExponent = std::clamp(stepExponent, 0, 30);
+                    simulation.SetStepExponent(stepExponent);
+                }
+                else if (keyPress == sf::Keyboard::Key::M)
+                {
+                    maxSpeed = !maxSpeed;
+                    simulation.SetMaxSpeed(maxSpeed);
                 }
             }
             else if (event->is<sf::Event::Resized>()) {
@@ -297,18 +305,6 @@ int main() {
         }
 
         float deltaTime = clock.restart().asSeconds();
-        accumulator += deltaTime * (isPlaying ? 1 : 0);
-        elapsedTime += deltaTime;
-
-        // Process the grid update at a fixed timestep
-        while (accumulator >= timeStep) {
-            currentWorld.Simulate(globalRule);
-            //currentWorld.PrintRLE();
-            
-            accumulator -= timeStep;
-        }
-
-        deltaTime = clock.restart().asSeconds();
         elapsedTime += deltaTime;
         frameCount++;
 
@@ -319,19 +315,20 @@ int main() {
             frameCount = 0;
         }
 
-        window.clear(colors[currentWorld.VoidState]);
+        window.clear(colors[currentWorld->VoidState]);
         window.setView(view);
 
         if (isRightMouseDown) {
             sf::Vector2i pixelPos = sf::Mouse::getPosition(window);
             sf::Vector2f mouseWorldPos = window.mapPixelToCoords(pixelPos, view);
 
-            sf::Vector2i pos = currentWorld.GetWorldCoords(mouseWorldPos);
+            sf::Vector2i pos = currentWorld->GetWorldCoords(mouseWorldPos);
 
-            if (currentWorld.Generation == 0)
+            if (currentWorld->Generation == 0)
                 originalWorld.PaintAtCell(pos, drawingState);
 
-            currentWorld.PaintAtCell(pos, drawingState);
+            int state = drawingState;
+            simulation.Post([pos, state](World& w) { w.PaintAtCell(pos, state); });
         }
         if (isLeftMouseDown) {
             window.setView(view);  // Use current view for mapping
@@ -343,10 +340,22 @@ int main() {
             previousMousePosition = window.mapPixelToCoords(sf::Mouse::getPosition(window));  // <== Update after view.move
         }
         std::vector<sf::Color> colorVec(std::begin(colors), std::end(colors));
-        currentWorld.Draw(window, colorVec);
+        chunkRenderer.Draw(window, *currentWorld, colorVec);
 
         // Draw UI
         window.setView(uiView);
+
+        std::string status = "Gen " + std::to_string(currentWorld->Generation) + "    " +
+            std::to_string(static_cast<long long>(simulation.GenerationsPerSecond())) + " gens/s";
+        if (stepExponent > 0)
+            status += "    Step 2^" + std::to_string(stepExponent);
+        if (maxSpeed)
+            status += "    Max speed";
+        if (engine == ENGINE_HASHLIFE)
+            status += "    HashLife";
+        statusText.setString(status);
+        window.draw(statusText);
+
         menuManager.Draw(window, static_cast<sf::Vector2f>(sf::Mouse::getPosition(window)));
         mainGui.Draw(window);
 
@@ -368,6 +377,15 @@ int main() {
                 ruleEditor.Draw(secondWindow.get(), colors, ruleEditorColors, globalRule);
             }
         }
+
+        ruleEditor.Update(globalRule);
+
+        // The simulation runs on its own copy of the rule, so hand it every edit
+        if (globalRule.Version != postedRuleVersion)
+        {
+            simulation.SetRule(globalRule);
+            postedRuleVersion = globalRule.Version;
+        }
     }
 
     return 0;
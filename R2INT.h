@@ -3,12 +3,9 @@
 #include "resource.h"
 #include "Debug.h"
 #include "OffsetStruct.h"
+#include "RuleAnalysis.h"
 #include <vector>
 
-#define SHAPE_SQUARE 128
-#define SHAPE_DIAMOND 129
-#define SHAPE_OCTAGON 130
-
 #define RS_B0 0
 #define RS_NORMAL 1
 #define RS_EXPLOSIVELESS 2
@@ -1,107 +1,372 @@
+#include <algorithm>
+#include <chrono>
+#include <cstring>
 #include <fstream>
 #include <iostream>
-#include <random>
 #include <string>
+#include <string_view>
+#include <vector>
+#include "BitOps.h"
+#include "IsotropicRules.h"
 #include "OffsetStruct.h"
 #include "R2INT_File.h"
+#include "Symmetry.h"
+#include "ThreadPool.h"
 
-void SaveTor2intFile(R2INTRules& saveRule)
+// Text files are formatted and parsed in parallel (each pool uses its own threads, so this is safe off the UI thread)
+#define R2INT_FILE_BLOCK_WORDS 4096            // Table words per formatting job
+#define R2INT_FILE_WAVE_BLOCKS 16              // Jobs formatted before their text is written out
+#define R2INT_FILE_BUFFER_BYTES (1 << 20)      // Output stream buffer
+#define R2INT_FILE_MIN_SLICE_BYTES (64 * 1024) // Smallest slice of a file worth parsing on its own
+
+// Order of the cells on a line: the centre, the Moore ring, then the outer ring
+static const int R2intLineOrder[25] = {
+    12, 7, 8, 13, 18, 17, 16, 11, 6, 2,
+     3,  4, 9, 14, 19, 24, 23, 22, 21, 20,
+    15, 10, 5,  0,  1
+};
+
+// The 25 cells of a transition as a line of a .r2int file, without the newline
+static void AppendR2intLine(std::string& text, int Transition)
+{
+    for (int k : R2intLineOrder)
+        text += static_cast<char>('0' + ((Transition >> (24 - k)) & 1));
+}
+
+bool HasR2binExtension(const std::string& path)
+{
+    const std::string extension = R2INT_BINARY_EXTENSION;
+    return path.size() >= extension.size() && path.substr(path.size() - extension.size()) == extension;
+}
+
+// The filename typed on the console, with .r2int appended unless it already names a .r2int or .r2bin file
+std::string AskForRuleFilename(const std::string& action)
 {
-    std::cout << "Enter the filename to save your rule to: ";
-    std::string saveName = "";
-    std::cin >> saveName;
+    std::cout << "Enter the filename to " << action << " (.r2int, or .r2bin for binary): ";
+    std::string name = "";
+    std::cin >> name;
 
     // Append extension if not already present
-    if (saveName.size() < 6 || saveName.substr(saveName.size() - 6) != ".r2int")
+    if (!HasR2binExtension(name) && (name.size() < 6 || name.substr(name.size() - 6) != ".r2int"))
     {
-        saveName += ".r2int";
+        name += ".r2int";
     }
+    return name;
+}
+
+bool SaveRuleFile(const R2INTRules& rules, const std::string& path)
+{
+    return HasR2binExtension(path) ? SaveToR2binFile(rules, path) : SaveTor2intFile(rules, path);
+}
+
+bool LoadRuleFile(R2INTRules& rules, const std::string& path)
+{
+    return HasR2binExtension(path) ? LoadFromR2binFile(rules, path) : LoadFromr2intFile(rules, path);
+}
 
-    std::ofstream outFile(saveName);
+bool SaveTor2intFile(const R2INTRules& saveRule, const std::string& saveName)
+{
+    auto start = std::chrono::steady_clock::now();
+
+    std::vector<char> buffer(R2INT_FILE_BUFFER_BYTES);
+    std::ofstream outFile;
+    outFile.rdbuf()->pubsetbuf(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+    outFile.open(saveName);
     if (!outFile)
     {
         std::cerr << "Error: Could not open " << saveName << " for writing.\n";
-        return;
+        return false;
     }
 
     std::cout << "Saving to " << saveName << std::endl;
 
-    for (int i = 0; i < 33554432; i++)
+    // One line per isotropic class that is on, in ascending order of its lowest transition: the table words masked by
+    // the class map's canonical bitmap. Blocks are formatted in parallel, a wave at a time so memory stays bounded,
+    // and written in order
+    const IsotropicClassMap& classes = IsotropicClassMap::Get();
+    ThreadPool pool(ThreadPool::ResolveThreadCount(0));
+    const int blockCount = R2INTRules::WordCount / R2INT_FILE_BLOCK_WORDS;
+    std::vector<std::string> blockText(R2INT_FILE_WAVE_BLOCKS);
+
+    for (int wave = 0; wave < blockCount; wave += R2INT_FILE_WAVE_BLOCKS)
+    {
+        pool.ParallelFor(R2INT_FILE_WAVE_BLOCKS, [&](int i) {
+            std::string& text = blockText[i];
+            text.clear();
+
+            int end = (wave + i + 1) * R2INT_FILE_BLOCK_WORDS;
+            for (int w = (wave + i) * R2INT_FILE_BLOCK_WORDS; w < end; w++)
+            {
+                for (uint64_t bits = saveRule.GetWord(w) & classes.CanonicalWord(w); bits; bits &= bits - 1)
+                {
+                    AppendR2intLine(text, w * 64 + CountTrailingZeros64(bits));
+                    text += '\n';
+                }
+            }
+            });
+
+        for (const std::string& text : blockText)
+            outFile.write(text.data(), static_cast<std::streamsize>(text.size()));
+    }
+
+    outFile.close();
+    if (!outFile)
     {
-        if (FindLowestNeighborhoodValue(i) != i)
+        std::cerr << "Error: Could not write " << saveName << ".\n";
+        return false;
+    }
+
+    auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start);
+    std::cout << "Save complete! (" << elapsed.count() << " ms)" << std::endl;
+    return true;
+}
+
+bool LoadFromr2intFile(R2INTRules& loadRule, const std::string& loadName)
+{
+    auto start = std::chrono::steady_clock::now();
+
+    MappedFile file;
+    if (!file.Open(loadName))
+        return false;
+    std::cout << "Loading from " << loadName << std::endl;
+
+    // Cut the file into slices at line starts and parse them in parallel; each slice keeps its own
+    // transitions and warnings, which are then applied and printed in file order
+    ThreadPool pool(ThreadPool::ResolveThreadCount(0));
+    const char* text = reinterpret_cast<const char*>(file.Data());
+    const std::size_t size = file.Size();
+    const int sliceCount = std::max(1, std::min(pool.ThreadCount() * 4, static_cast<int>(size / R2INT_FILE_MIN_SLICE_BYTES)));
+
+    std::vector<std::size_t> sliceStart(sliceCount + 1, size);
+    for (int i = 0; i < sliceCount; i++)
+    {
+        std::size_t at = size * i / sliceCount;
+        while (at > 0 && at < size && text[at - 1] != '\n')
+            at++;
+        sliceStart[i] = at;
+    }
+
+    std::vector<std::vector<int>> transitions(sliceCount);
+    std::vector<std::vector<std::string>> warnings(sliceCount);
+
+    pool.ParallelFor(sliceCount, [&](int i) {
+        std::size_t at = sliceStart[i];
+        const std::size_t end = std::max(at, sliceStart[i + 1]);
+
+        while (at < end)
         {
-            continue;
+            const char* newline = static_cast<const char*>(std::memchr(text + at, '\n', size - at));
+            std::size_t lineEnd = newline ? static_cast<std::size_t>(newline - text) : size;
+            std::string_view line(text + at, lineEnd - at);
+            at = lineEnd + 1;
+
+            if (!line.empty() && line.back() == '\r')
+                line.remove_suffix(1); // Saved in text mode on Windows
+
+            if (line.length() != 25)
+            {
+                warnings[i].push_back("Warning: Skipping invalid line (incorrect length): " + std::string(line));
+                continue;
+            }
+
+            int t = 0;
+            bool valid = true;
+            for (int c = 0; c < 25; c++)
+            {
+                if (line[c] != '0' && line[c] != '1')
+                    valid = false;
+                t |= (line[c] == '1' ? 1 : 0) << (24 - R2intLineOrder[c]);
+            }
+
+            if (!valid)
+            {
+                warnings[i].push_back("Warning: Skipping invalid line (cells must be 0 or 1): " + std::string(line));
+                continue;
+            }
+            transitions[i].push_back(t);
         }
-        if (saveRule.R2MAP[i] == true)
-        {
-            Neighborhood n = ConvertIntToNeighborhood(i);
+        });
+
+    // Clear existing rule, then set every symmetric variant of each line
+    loadRule.Fill(false);
+    uint64_t* words = loadRule.R2MAP.data();
+    for (int i = 0; i < sliceCount; i++)
+    {
+        for (const std::string& warning : warnings[i])
+            std::cerr << warning << "\n";
 
-            outFile << n[12] << n[7] << n[8] << n[13] << n[18] << n[17] << n[16] << n[11] << 
-                n[6] << n[2] << n[3] << n[4] << n[9] << n[14] << n[19] << n[24] << n[23] << 
-                n[22] << n[21] << n[20] << n[15] << n[10] << n[5] << n[0] << n[1] << std::endl;
+        for (int t : transitions[i])
+        {
+            for (int s : TransitionSymmetries(t))
+                words[s >> 6] |= uint64_t(1) << (s & 63);
         }
     }
+    loadRule.Version++;
 
-    outFile.close();
-    std::cout << "Save complete!" << std::endl;
+    auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start);
+    std::cout << "Load complete! (" << elapsed.count() << " ms)" << std::endl;
+    return true;
 }
 
-void LoadFromr2intFile(R2INTRules& loadRule)
+uint64_t TableChecksum(const uint64_t* words, std::size_t count)
 {
-    std::cout << "Enter the filename to load your rule from: ";
-    std::string loadName = "";
-    std::cin >> loadName;
-    // Append extension if not already present
-    if (loadName.size() < 6 || loadName.substr(loadName.size() - 6) != ".r2int")
+    uint64_t hash = 14695981039346656037ull;
+    for (std::size_t i = 0; i < count; i++)
     {
-        loadName += ".r2int";
+        hash ^= words[i];
+        hash *= 1099511628211ull;
     }
-    std::ifstream inFile(loadName);
-    if (!inFile)
+    return hash;
+}
+
+// The table is written as the host stores it, which must be little-endian for files to be portable
+static bool IsLittleEndian()
+{
+    const uint16_t probe = 1;
+    uint8_t low;
+    std::memcpy(&low, &probe, 1);
+    return low == 1;
+}
+
+bool MappedR2INTRules::Open(const std::string& path)
+{
+    words = nullptr;
+    if (!IsLittleEndian())
     {
-        std::cerr << "Error: Could not open " << loadName << " for reading.\n";
-        return;
+        std::cerr << "Error: Binary rule files are only supported on little-endian machines.\n";
+        return false;
     }
-    std::cout << "Loading from " << loadName << std::endl;
-    // Clear existing rule
-    for (unsigned int i = 0; i < 33554432; i++)
+
+    if (!file.Open(path))
+        return false;
+
+    R2INTBinaryHeader header;
+    if (file.Size() < sizeof(header))
     {
-        loadRule[i] = 0;
+        std::cerr << "Error: " << path << " is too short to be a binary rule file.\n";
+        return false;
     }
-    std::string line;
-    while (std::getline(inFile, line))
+    std::memcpy(&header, file.Data(), sizeof(header));
+
+    if (std::memcmp(header.Magic, "R2INTBIN", sizeof(header.Magic)) != 0)
     {
-        if (line.length() != 25)
-        {
-            std::cerr << "Warning: Skipping invalid line (incorrect length): " << line << std::endl;
-            continue;
-        }
-        Neighborhood n;
-        const int perm[25] = {
-        12, 7, 8, 13, 18, 17, 16, 11, 6, 2,
-         3,  4, 9, 14, 19, 24, 23, 22, 21, 20,
-        15, 10, 5,  0,  1
-        };
-
-        for (int i = 0; i < 25; i++)
-        {
-            int bit = (line[i] == '1') ? 1 : 0;
-            n[perm[i]] = bit;
-        }
+        std::cerr << "Error: " << path << " is not a binary rule file.\n";
+        return false;
+    }
+    if (header.Version > R2INT_BINARY_VERSION)
+    {
+        std::cerr << "Error: " << path << " is version " << header.Version << ", newer than this program supports ("
+            << R2INT_BINARY_VERSION << ").\n";
+        return false;
+    }
 
-        if (n[12] > 1)
-        {
-            std::cerr << "Warning: Skipping invalid line (center cell state > 1): " << line << std::endl;
-            continue;
-        }
+    const std::size_t tableBytes = sizeof(uint64_t) * R2INTRules::WordCount;
+    if (header.WordCount != static_cast<uint64_t>(R2INTRules::WordCount) || header.TableOffset % alignof(uint64_t) != 0 ||
+        header.TableOffset < sizeof(header) || file.Size() < header.TableOffset + tableBytes)
+    {
+        std::cerr << "Error: " << path << " has a malformed or truncated table.\n";
+        return false;
+    }
 
-        // Set rule for all symmetric variants
-        for (const auto& variant : GetAllSymmetries(n))
-        {
-            int index = ConvertNeighborhoodToInt(variant);
-            loadRule[index] = 1;
-        }
+    // Mappings are page-aligned and the offset is a multiple of 8, so the table can be read in place
+    const uint64_t* table = reinterpret_cast<const uint64_t*>(file.Data() + header.TableOffset);
+    if (TableChecksum(table, R2INTRules::WordCount) != header.Checksum)
+    {
+        std::cerr << "Error: " << path << " failed its checksum; the file is corrupt.\n";
+        return false;
+    }
+
+    words = table;
+    return true;
+}
+
+bool SaveToR2binFile(const R2INTRules& rules, const std::string& path)
+{
+    if (!IsLittleEndian())
+    {
+        std::cerr << "Error: Binary rule files are only supported on little-endian machines.\n";
+        return false;
     }
-    inFile.close();
-    std::cout << "Load complete!" << std::endl;
-}
\ No newline at end of file
+
+    std::ofstream outFile(path, std::ios::binary);
+    if (!outFile)
+    {
+        std::cerr << "Error: Could not open " << path << " for writing.\n";
+        return false;
+    }
+
+    std::cout << "Saving to " << path << std::endl;
+
+    R2INTBinaryHeader header{};
+    std::memcpy(header.Magic, "R2INTBIN", sizeof(header.Magic));
+    header.Version = R2INT_BINARY_VERSION;
+    header.TableOffset = sizeof(header);
+    header.WordCount = R2INTRules::WordCount;
+    header.Checksum = TableChecksum(rules.R2MAP.data(), rules.R2MAP.size());
+
+    outFile.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    outFile.write(reinterpret_cast<const char*>(rules.R2MAP.data()), sizeof(uint64_t) * rules.R2MAP.size());
+    outFile.close();
+    if (!outFile)
+    {
+        std::cerr << "Error: Could not write " << path << ".\n";
+        return false;
+    }
+
+    std::cout << "Save complete!" << std::endl;
+    return true;
+}
+
+bool LoadFromR2binFile(R2INTRules& rules, const std::string& path)
+{
+    auto start = std::chrono::steady_clock::now();
+
+    MappedR2INTRules mapped;
+    if (!mapped.Open(path))
+        return false;
+
+    rules.Version++;
+    std::memcpy(rules.R2MAP.data(), mapped.Words(), sizeof(uint64_t) * R2INTRules::WordCount);
+
+    auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start);
+    std::cout << "Loaded " << path << " in " << elapsed.count() << " ms." << std::endl;
+    return true;
+}
+
+bool ConvertR2intToR2bin(const std::string& textPath, const std::string& binaryPath)
+{
+    R2INTRules rules;
+    return LoadFromr2intFile(rules, textPath) && SaveToR2binFile(rules, binaryPath);
+}
+
+bool ConvertR2binToR2int(const std::string& binaryPath, const std::string& textPath)
+{
+    R2INTRules rules;
+    return LoadFromR2binFile(rules, binaryPath) && SaveTor2intFile(rules, textPath);
+}
+
+bool DiffRuleFiles(const std::string& oldPath, const std::string& newPath)
+{
+    R2INTRules oldRaw;
+    R2INTRules newRaw;
+    if (!LoadRuleFile(oldRaw, oldPath) || !LoadRuleFile(newRaw, newPath))
+        return false;
+
+    IsotropicR2INTRules oldRule;
+    IsotropicR2INTRules newRule;
+    oldRule.FromRaw(oldRaw);
+    newRule.FromRaw(newRaw);
+
+    const IsotropicClassMap& classes = IsotropicClassMap::Get();
+    std::vector<int> changed = oldRule.Diff(newRule);
+    std::string text;
+    for (int c : changed)
+    {
+        text += newRule.Get(c) ? '+' : '-';
+        AppendR2intLine(text, classes.Representative(c));
+        text += '\n';
+    }
+
+    std::cout << text << changed.size() << " of " << classes.ClassCount() << " isotropic classes differ." << std::endl;
+    return true;
+}
@@ -1,8 +1,65 @@
 #pragma once
 
+#include <cstdint>
 #include <fstream>
 #include <iostream>
+#include <string>
+#include "MappedFile.h"
 #include "OffsetStruct.h"
 
-void SaveTor2intFile(R2INTRules& saveRule);
-void LoadFromr2intFile(R2INTRules& loadRule);
\ No newline at end of file
+// Rule I/O takes paths and never touches the console, so it can run on a background thread or in the headless tools
+// Every function prints what it did and returns false on failure; a failed load leaves the rule untouched
+
+// Text rule files (.r2int): one 25-character line per isotropic transition that is on
+bool SaveTor2intFile(const R2INTRules& saveRule, const std::string& saveName);
+bool LoadFromr2intFile(R2INTRules& loadRule, const std::string& loadName);
+
+// Binary rule files (.r2bin): a 64-byte header followed by the packed table exactly as R2INTRules stores it
+// (little-endian words), so loading is a checksum and a copy rather than a parse
+#define R2INT_BINARY_EXTENSION ".r2bin"
+#define R2INT_BINARY_VERSION 1
+
+struct R2INTBinaryHeader {
+    char Magic[8];         // "R2INTBIN"
+    uint32_t Version;      // R2INT_BINARY_VERSION of the writer
+    uint32_t TableOffset;  // Bytes from the start of the file to the table
+    uint64_t WordCount;    // R2INTRules::WordCount
+    uint64_t Checksum;     // FNV-1a over the table words
+    uint8_t Reserved[32];  // Zero
+};
+static_assert(sizeof(R2INTBinaryHeader) == 64, "R2INTBinaryHeader is part of the file format");
+
+// A .r2bin file mapped read-only and checked, whose table can be read in place
+class MappedR2INTRules {
+public:
+    bool Open(const std::string& path); // Prints the reason and returns false if the file isn't a valid table
+
+    const uint64_t* Words() const { return words; }
+    bool Get(int Index) const { return (words[Index >> 6] >> (Index & 63)) & 1; }
+
+private:
+    MappedFile file;
+    const uint64_t* words = nullptr;
+};
+
+// FNV-1a over a run of words, as stored in R2INTBinaryHeader::Checksum
+uint64_t TableChecksum(const uint64_t* words, std::size_t count);
+
+bool SaveToR2binFile(const R2INTRules& rules, const std::string& path);
+bool LoadFromR2binFile(R2INTRules& rules, const std::string& path);
+
+// Converters between the two formats
+bool ConvertR2intToR2bin(const std::string& textPath, const std::string& binaryPath);
+bool ConvertR2binToR2int(const std::string& binaryPath, const std::string& textPath);
+
+// Prints the isotropic classes that differ between two rule files as .r2int lines,
+// marked + when only the new rule has the class on and - when only the old one does
+bool DiffRuleFiles(const std::string& oldPath, const std::string& newPath);
+
+// Saves or loads by extension: .r2bin is binary, anything else text
+bool HasR2binExtension(const std::string& path);
+bool SaveRuleFile(const R2INTRules& rules, const std::string& path);
+bool LoadRuleFile(R2INTRules& rules, const std::string& path);
+
+// Prompts for a rule filename on the console (blocks, so call it off the UI thread)
+std::string AskForRuleFilename(const std::string& action);
@@ -0,0 +1,152 @@
+#include "RuleAnalysis.h"
+#include "BitOps.h"
+
+// Word w of the table holds transitions 64w to 64w + 63, so the centre n[12] is bit 6 of w
+#define ANALYSIS_CENTRE_WORD_BIT 6
+
+TotalisticWords::TotalisticWords(uint32_t countMask, uint32_t birth, uint32_t survival) : Mask(countMask)
+{
+    uint32_t lowMask = countMask & 63;
+    for (int centre = 0; centre < 2; centre++)
+    {
+        uint32_t result = centre ? survival : birth;
+        for (int highCount = 0; highCount < 26; highCount++)
+        {
+            for (int b = 0; b < 64; b++)
+            {
+                int count = highCount + PopCount64(b & lowMask);
+                if (count < 26 && ((result >> count) & 1))
+                    Patterns[centre][highCount] |= uint64_t(1) << b;
+            }
+        }
+    }
+}
+
+uint64_t TotalisticWords::operator()(int w) const
+{
+    uint64_t high = static_cast<uint64_t>(w) << 6;
+    return Patterns[(w >> ANALYSIS_CENTRE_WORD_BIT) & 1][PopCount64(high & Mask)];
+}
+
+// Tries the rule as outer-totalistic over countMask; counts come from one sample transition each
+static bool MatchTotalistic(const R2INTRules& rules, uint32_t countMask, TotalisticRule& result)
+{
+    uint32_t birth = 0;
+    uint32_t survival = 0;
+    int transition = 0;
+    for (int count = 0; count <= PopCount64(countMask); count++)
+    {
+        if (rules.Get(transition))
+            birth |= uint32_t(1) << count;
+        if (rules.Get(transition | (1 << 12)))
+            survival |= uint32_t(1) << count;
+
+        uint32_t remaining = countMask & ~static_cast<uint32_t>(transition);
+        if (remaining)
+            transition |= 1 << CountTrailingZeros64(remaining);
+    }
+
+    TotalisticWords words(countMask, birth, survival);
+    for (int w = 0; w < R2INTRules::WordCount; w++)
+    {
+        if (rules.GetWord(w) != words(w))
+            return false;
+    }
+
+    result.Birth = birth;
+    result.Survival = survival;
+    return true;
+}
+
+TotalisticRule AnalyzeTotalistic(const R2INTRules& rules)
+{
+    TotalisticRule result;
+    if (MatchTotalistic(rules, TOTALISTIC_MOORE_MASK, result))
+        result.Range = 1;
+    else if (MatchTotalistic(rules, TOTALISTIC_RANGE2_MASK, result))
+        result.Range = 2;
+    return result;
+}
+
+// Whether flipping transition bit j ever changes the result; stops at the first pair that differs
+static bool DependsOnBit(const uint64_t* words, int j)
+{
+    if (j < 6)
+    {
+        // Bits 0-5 pick the bit within a word, so flipping bit j swaps bits 2^j apart;
+        // lowHalf marks the bits whose bit j is clear
+        static const uint64_t LowHalves[6] = {
+            0x5555555555555555ull, 0x3333333333333333ull, 0x0F0F0F0F0F0F0F0Full,
+            0x00FF00FF00FF00FFull, 0x0000FFFF0000FFFFull, 0x00000000FFFFFFFFull
+        };
+        uint64_t lowHalf = LowHalves[j];
+        int shift = 1 << j;
+        for (int w = 0; w < R2INTRules::WordCount; w++)
+        {
+            if (((words[w] >> shift) ^ words[w]) & lowHalf)
+                return true;
+        }
+        return false;
+    }
+
+    // Higher bits flip whole words: compare each run of words with the run stride words further on
+    int stride = 1 << (j - 6);
+    for (int base = 0; base < R2INTRules::WordCount; base += 2 * stride)
+    {
+        for (int w = base; w < base + stride; w++)
+        {
+            if (words[w] != words[w + stride])
+                return true;
+        }
+    }
+    return false;
+}
+
+uint32_t RuleDependencies(const R2INTRules& rules)
+{
+    uint32_t dependencies = 0;
+    for (int j = 0; j < 25; j++)
+    {
+        if (DependsOnBit(rules.R2MAP.data(), j))
+            dependencies |= uint32_t(1) << j;
+    }
+    return dependencies;
+}
+
+int RuleShape(uint32_t dependencies)
+{
+    if ((dependencies & ~SHAPE_DIAMOND_MASK) == 0)
+        return SHAPE_DIAMOND;
+    if ((dependencies & ~SHAPE_OCTAGON_MASK) == 0)
+        return SHAPE_OCTAGON;
+    return SHAPE_SQUARE;
+}
+
+std::shared_ptr<const ShapedRule> BuildShapedRule(const R2INTRules& rules)
+{
+    // The corners rule out both shapes and most rules read them, so look there first
+    const uint64_t* words = rules.R2MAP.data();
+    for (uint32_t corners = SHAPE_SQUARE_MASK & ~SHAPE_OCTAGON_MASK; corners; corners &= corners - 1)
+    {
+        if (DependsOnBit(words, CountTrailingZeros64(corners)))
+            return nullptr;
+    }
+
+    int shape = RuleShape(RuleDependencies(rules));
+    uint32_t mask = shape == SHAPE_DIAMOND ? SHAPE_DIAMOND_MASK : SHAPE_OCTAGON_MASK;
+    int entries = 1 << PopCount64(mask);
+
+    auto shaped = std::make_shared<ShapedRule>();
+    shaped->Shape = shape;
+    shaped->Table.assign(entries / 64, 0);
+
+    // (t - mask) & mask steps through the subsets of mask in increasing order, which is compact index order
+    int transition = 0;
+    for (int i = 0; i < entries; i++)
+    {
+        if (rules.Get(transition))
+            shaped->Table[i >> 6] |= uint64_t(1) << (i & 63);
+        transition = (transition - static_cast<int>(mask)) & static_cast<int>(mask);
+    }
+    return shaped;
+}
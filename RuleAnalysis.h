@@ -0,0 +1,87 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "OffsetStruct.h"
+
+// Neighborhood shapes a rule can be restricted to
+#define SHAPE_SQUARE 128  // The whole 5x5
+#define SHAPE_DIAMOND 129 // |dx| + |dy| <= 2, 13 cells (includes the Moore neighborhood)
+#define SHAPE_OCTAGON 130 // The 5x5 without its corners, 21 cells
+
+// Transition bits of each shape
+#define SHAPE_SQUARE_MASK  0x01FFFFFFu
+#define SHAPE_DIAMOND_MASK 0x00477DC4u
+#define SHAPE_OCTAGON_MASK 0x00EFFFEEu
+
+// Transition bits (n[k] at bit 24 - k) of the cells around the centre
+#define TOTALISTIC_MOORE_MASK  0x000729C0u // n[6..8], n[11], n[13], n[16..18]
+#define TOTALISTIC_RANGE2_MASK 0x01FFEFFFu // All 24 cells except n[12]
+
+// Rule whose next state only depends on the centre cell and how many of the cells around it are alive
+struct TotalisticRule {
+    int Range = 0;         // 1 = the Moore neighborhood, 2 = the whole 5x5; 0 = the rule isn't outer-totalistic
+    uint32_t Birth = 0;    // Bit n: a dead cell with n live neighbors is born
+    uint32_t Survival = 0; // Bit n: a live cell with n live neighbors survives
+
+    bool operator==(const TotalisticRule& other) const {
+        return Range == other.Range && Birth == other.Birth && Survival == other.Survival;
+    }
+};
+
+// Table words of a rule that counts the cells in countMask (transition bits, may include the centre)
+// The low 6 bits of a transition are the same cells in every word, so each word is one of
+// 2 * 26 patterns picked by the centre and the live count in the rest of the transition
+class TotalisticWords {
+public:
+    TotalisticWords(uint32_t countMask, uint32_t birth, uint32_t survival);
+
+    uint64_t operator()(int w) const;
+
+private:
+    uint32_t Mask;
+    std::array<std::array<uint64_t, 26>, 2> Patterns{};
+};
+
+// Reads the B/S counts off the table and checks every word against them, range 1 first
+// Gives up at the first word that doesn't match, so other rules are rejected almost immediately
+TotalisticRule AnalyzeTotalistic(const R2INTRules& rules);
+
+// Transition bits (cells) the rule's result actually depends on
+// A cell is ignored when flipping it never changes the result; scanning stops once every cell is needed
+uint32_t RuleDependencies(const R2INTRules& rules);
+
+// Smallest shape that covers the dependencies
+int RuleShape(uint32_t dependencies);
+
+// Compact index of a transition: the cells of the shape in transition order, gathered with fixed shifts
+constexpr int DiamondIndex(int Transition)
+{
+    return ((Transition >> 22) & 1) << 12 | ((Transition >> 16) & 7) << 9 | ((Transition >> 10) & 31) << 4 |
+        ((Transition >> 6) & 7) << 1 | ((Transition >> 2) & 1);
+}
+
+constexpr int OctagonIndex(int Transition)
+{
+    return ((Transition >> 21) & 7) << 18 | ((Transition >> 5) & 0x7FFF) << 3 | ((Transition >> 1) & 7);
+}
+
+static_assert(DiamondIndex(SHAPE_DIAMOND_MASK) == (1 << 13) - 1 && DiamondIndex(~SHAPE_DIAMOND_MASK & SHAPE_SQUARE_MASK) == 0,
+    "DiamondIndex gathers exactly the diamond");
+static_assert(OctagonIndex(SHAPE_OCTAGON_MASK) == (1 << 21) - 1 && OctagonIndex(~SHAPE_OCTAGON_MASK & SHAPE_SQUARE_MASK) == 0,
+    "OctagonIndex gathers exactly the octagon");
+
+// Rule that only reads the cells of a diamond or octagon, as a bit table over those cells alone:
+// 2^13 bits (1 KB) for a diamond, 2^21 bits (256 KB) for an octagon, instead of the 4 MB full table
+struct ShapedRule {
+    int Shape = SHAPE_SQUARE;
+    std::vector<uint64_t> Table;
+
+    bool Get(int CompactIndex) const {
+        return (Table[CompactIndex >> 6] >> (CompactIndex & 63)) & 1;
+    }
+};
+
+// Compacted copy of the rule for its shape, or nullptr when it needs the whole square
+std::shared_ptr<const ShapedRule> BuildShapedRule(const R2INTRules& rules);
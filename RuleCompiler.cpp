@@ -0,0 +1,398 @@
+#include "RuleCompiler.h"
+#include "BitOps.h"
+#include "RuleAnalysis.h"
+#include "ThreadPool.h"
+#include <array>
+#include <cctype>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+// Table words compiled per ParallelFor index
+#define RULE_COMPILER_BLOCK_WORDS 4096
+
+// Word w of the table holds transitions 64w to 64w + 63, and n[k] is transition bit 24 - k,
+// so n[k] is bit 18 - k of w for every k up to 18: the whole Moore neighbourhood lives in the low 13 bits of w
+// and the outer cells below it vary within the word
+#define RULE_MOORE_WORD_BITS 13
+#define RULE_CENTRE_WORD_BIT 6
+
+// Moore ring clockwise from north (n[7], n[8], n[13], n[18], n[17], n[16], n[11], n[6]) as bits of w
+static const int RingWordBits[8] = { 11, 10, 5, 0, 1, 2, 7, 12 };
+
+// Hensel letters for 1-4 live neighbours; 5-7 use the letters of 8 - n for the complementary configurations
+static const char* HenselLetters[5] = { "", "ce", "cekain", "cekainyqjr", "cekainyqjrtwz" };
+
+// One configuration per letter, as ring bits (bit 0 = N, 1 = NE, ... 7 = NW)
+static const uint8_t HenselConfigurations[5][13] = {
+    {},
+    { 0x02, 0x01 },
+    { 0x0A, 0x05, 0x09, 0x03, 0x11, 0x22 },
+    { 0x2A, 0x45, 0x25, 0x07, 0x83, 0x0D, 0x29, 0x0B, 0x13, 0x23 },
+    { 0xAA, 0x55, 0x2D, 0x0F, 0x1B, 0x47, 0xA9, 0x27, 0x4D, 0xA3, 0x93, 0x8D, 0x33 },
+};
+
+// Transition table for a range 1 rule, indexed by ring bits
+struct RingRule {
+    std::array<bool, 256> Birth{};
+    std::array<bool, 256> Survival{};
+};
+
+// Outer-totalistic rule over an arbitrary set of cells, indexed by live count
+struct CountRule {
+    uint32_t Mask = 0; // Transition bits that are counted
+    std::array<bool, 26> Birth{};
+    std::array<bool, 26> Survival{};
+};
+
+static uint8_t RotateRing(uint8_t ring)
+{
+    return static_cast<uint8_t>((ring << 2) | (ring >> 6));
+}
+
+static uint8_t MirrorRing(uint8_t ring)
+{
+    // N and S stay put, the rest swap east with west
+    uint8_t mirrored = 0;
+    for (int p = 0; p < 8; p++)
+    {
+        if (ring & (1 << p))
+            mirrored |= 1 << ((8 - p) % 8);
+    }
+    return mirrored;
+}
+
+// Letter index (into HenselLetters[min(n, 8 - n)]) of every ring configuration
+static std::array<int8_t, 256> BuildHenselLetterTable()
+{
+    std::array<int8_t, 256> letters;
+    letters.fill(-1);
+
+    for (int count = 1; count <= 4; count++)
+    {
+        for (int letter = 0; letter < static_cast<int>(std::strlen(HenselLetters[count])); letter++)
+        {
+            uint8_t ring = HenselConfigurations[count][letter];
+            for (int mirror = 0; mirror < 2; mirror++)
+            {
+                for (int rotation = 0; rotation < 4; rotation++)
+                {
+                    letters[ring] = static_cast<int8_t>(letter);
+                    if (count < 4)
+                        letters[static_cast<uint8_t>(~ring)] = static_cast<int8_t>(letter);
+                    ring = RotateRing(ring);
+                }
+                ring = MirrorRing(ring);
+            }
+        }
+    }
+
+    return letters;
+}
+
+// Parses the digits and letters after a B or S, e.g. "2-a" or "34q"
+static bool ParseHenselList(const std::string& s, size_t& pos, std::array<bool, 256>& out)
+{
+    static const std::array<int8_t, 256> letterOf = BuildHenselLetterTable();
+
+    while (pos < s.size() && std::isdigit(static_cast<unsigned char>(s[pos])))
+    {
+        int count = s[pos++] - '0';
+        if (count > 8)
+        {
+            std::cerr << "Error: " << count << " neighbours is more than the Moore neighbourhood has.\n";
+            return false;
+        }
+
+        const char* valid = HenselLetters[count <= 4 ? count : 8 - count];
+
+        bool negate = pos < s.size() && s[pos] == '-';
+        if (negate)
+            pos++;
+
+        uint32_t letterMask = 0;
+        while (pos < s.size() && std::isalpha(static_cast<unsigned char>(s[pos])) && s[pos] != 'b' && s[pos] != 's')
+        {
+            const char* found = std::strchr(valid, s[pos]);
+            if (!found)
+            {
+                std::cerr << "Error: '" << s[pos] << "' is not a Hensel letter for " << count << " neighbours.\n";
+                return false;
+            }
+            letterMask |= 1u << (found - valid);
+            pos++;
+        }
+
+        if (negate && letterMask == 0)
+        {
+            std::cerr << "Error: '-' after " << count << " must be followed by letters.\n";
+            return false;
+        }
+
+        for (int ring = 0; ring < 256; ring++)
+        {
+            if (PopCount64(ring) != count)
+                continue;
+
+            bool listed = letterMask == 0 || ((letterMask >> letterOf[ring]) & 1);
+            if (listed != negate)
+                out[ring] = true;
+        }
+    }
+
+    return true;
+}
+
+// B3/S23, B36S23, B2-a/S12, ...
+static bool ParseHensel(const std::string& s, RingRule& rule)
+{
+    size_t pos = 0;
+    bool seen[2] = { false, false };
+
+    while (pos < s.size())
+    {
+        char c = s[pos++];
+        if (c == '/')
+            continue;
+
+        if (c != 'b' && c != 's')
+        {
+            std::cerr << "Error: expected B or S at '" << s.substr(pos - 1) << "'.\n";
+            return false;
+        }
+
+        bool birth = c == 'b';
+        if (seen[birth])
+        {
+            std::cerr << "Error: " << (birth ? "B" : "S") << " is given twice.\n";
+            return false;
+        }
+        seen[birth] = true;
+
+        if (!ParseHenselList(s, pos, birth ? rule.Birth : rule.Survival))
+            return false;
+    }
+
+    if (!seen[0] && !seen[1])
+    {
+        std::cerr << "Error: empty rulestring.\n";
+        return false;
+    }
+    return true;
+}
+
+// One HROT list item: a value, a-b or a..b
+static bool ParseCountItem(const std::string& item, std::array<bool, 26>& out, int maxCount)
+{
+    if (item.empty())
+        return true; // "B" or "S" on its own is an empty list
+
+    size_t split = item.find("..");
+    size_t skip = 2;
+    if (split == std::string::npos)
+    {
+        split = item.find('-');
+        skip = 1;
+    }
+
+    auto ParseValue = [](const std::string& text, int& value) {
+        if (text.empty() || text.size() > 2)
+            return false;
+        for (char c : text)
+        {
+            if (!std::isdigit(static_cast<unsigned char>(c)))
+                return false;
+        }
+        value = std::stoi(text);
+        return true;
+    };
+
+    int from = 0;
+    int to = 0;
+    bool ok = split == std::string::npos
+        ? ParseValue(item, from) && ParseValue(item, to)
+        : ParseValue(item.substr(0, split), from) && ParseValue(item.substr(split + skip), to);
+
+    if (!ok || from > to || to > maxCount)
+    {
+        std::cerr << "Error: '" << item << "' is not a count or range of counts from 0 to " << maxCount << ".\n";
+        return false;
+    }
+
+    for (int i = from; i <= to; i++)
+        out[i] = true;
+    return true;
+}
+
+// R2,C2,S6-9,B7-8,NM and the LtL form R2,C2,M1,S5..8,B6..7,NM
+static bool ParseHROT(const std::string& s, CountRule& rule)
+{
+    std::vector<std::string> tokens;
+    size_t start = 0;
+    for (size_t comma; (comma = s.find(',', start)) != std::string::npos; start = comma + 1)
+        tokens.push_back(s.substr(start, comma - start));
+    tokens.push_back(s.substr(start));
+
+    int range = 0;
+    bool countCentre = false;
+    char shape = 'm';
+    std::vector<std::string> lists[2]; // Birth, survival items
+
+    std::vector<std::string>* currentList = nullptr;
+    for (const std::string& token : tokens)
+    {
+        if (token.empty())
+        {
+            std::cerr << "Error: empty field in '" << s << "'.\n";
+            return false;
+        }
+
+        char key = token[0];
+        std::string value = token.substr(1);
+
+        if (std::isdigit(static_cast<unsigned char>(key)) && currentList)
+        {
+            currentList->push_back(token); // More items of the same list
+            continue;
+        }
+
+        currentList = nullptr;
+        if (key == 'r' && (value == "1" || value == "2"))
+            range = value[0] - '0';
+        else if (key == 'c' && (value == "0" || value == "2"))
+            ; // Two states is all this table holds
+        else if (key == 'm' && (value == "0" || value == "1"))
+            countCentre = value == "1";
+        else if (key == 'n' && (value == "m" || value == "n"))
+            shape = value[0];
+        else if (key == 'b' || key == 's')
+        {
+            currentList = &lists[key == 's'];
+            currentList->push_back(value);
+        }
+        else
+        {
+            std::cerr << "Error: unsupported field '" << token << "' (range 1-2, 2 states, NM or NN only).\n";
+            return false;
+        }
+    }
+
+    if (range == 0)
+    {
+        std::cerr << "Error: HROT rulestrings start with R1 or R2.\n";
+        return false;
+    }
+
+    int cells = 0;
+    for (int dy = -range; dy <= range; dy++)
+    {
+        for (int dx = -range; dx <= range; dx++)
+        {
+            bool centre = dx == 0 && dy == 0;
+            bool inside = shape == 'm' || std::abs(dx) + std::abs(dy) <= range;
+            if (inside && (!centre || countCentre))
+            {
+                int k = (dy + 2) * 5 + (dx + 2);
+                rule.Mask |= uint32_t(1) << (24 - k);
+                cells++;
+            }
+        }
+    }
+
+    for (int survival = 0; survival < 2; survival++)
+    {
+        for (const std::string& item : lists[survival])
+        {
+            if (!ParseCountItem(item, survival ? rule.Survival : rule.Birth, cells))
+                return false;
+        }
+    }
+    return true;
+}
+
+// Runs fill(w) for every word of the table, then marks the rule as edited
+template <typename Fill>
+static void FillWords(R2INTRules& rules, int threadCount, const Fill& fill)
+{
+    // A private pool: the shared one belongs to whichever thread is simulating
+    ThreadPool pool(ThreadPool::ResolveThreadCount(threadCount));
+
+    uint64_t* words = rules.R2MAP.data();
+    pool.ParallelFor(R2INTRules::WordCount / RULE_COMPILER_BLOCK_WORDS, [&](int block) {
+        int end = (block + 1) * RULE_COMPILER_BLOCK_WORDS;
+        for (int w = block * RULE_COMPILER_BLOCK_WORDS; w < end; w++)
+            words[w] = fill(w);
+        });
+
+    rules.Version++;
+}
+
+bool CompileRulestring(const std::string& rulestring, R2INTRules& rules, int threadCount)
+{
+    auto start = std::chrono::steady_clock::now();
+
+    std::string s;
+    for (char c : rulestring)
+    {
+        if (!std::isspace(static_cast<unsigned char>(c)))
+            s += static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    }
+
+    bool isHROT = s.size() > 1 && s[0] == 'r' && std::isdigit(static_cast<unsigned char>(s[1]));
+    if (isHROT)
+    {
+        CountRule rule;
+        if (!ParseHROT(s, rule))
+            return false;
+
+        uint32_t birth = 0;
+        uint32_t survival = 0;
+        for (int count = 0; count < 26; count++)
+        {
+            birth |= uint32_t(rule.Birth[count]) << count;
+            survival |= uint32_t(rule.Survival[count]) << count;
+        }
+
+        TotalisticWords words(rule.Mask, birth, survival);
+        FillWords(rules, threadCount, words);
+    }
+    else
+    {
+        RingRule rule;
+        if (!ParseHensel(s, rule))
+            return false;
+
+        // Range 1 rules ignore the outer cells, so every word is all ones or all zeros,
+        // decided by the Moore neighbourhood in its low 13 bits
+        std::vector<uint64_t> mooreWords(size_t(1) << RULE_MOORE_WORD_BITS);
+        for (int m = 0; m < static_cast<int>(mooreWords.size()); m++)
+        {
+            int ring = 0;
+            for (int p = 0; p < 8; p++)
+                ring |= ((m >> RingWordBits[p]) & 1) << p;
+
+            bool alive = (m >> RULE_CENTRE_WORD_BIT) & 1;
+            bool result = alive ? rule.Survival[ring] : rule.Birth[ring];
+            mooreWords[m] = result ? ~uint64_t(0) : uint64_t(0);
+        }
+
+        FillWords(rules, threadCount, [&](int w) {
+            return mooreWords[w & ((1 << RULE_MOORE_WORD_BITS) - 1)];
+            });
+    }
+
+    auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start);
+    std::cout << "Compiled " << rulestring << " in " << elapsed.count() << " ms." << std::endl;
+    return true;
+}
+
+bool SetRuleFromRulestring(R2INTRules& rules)
+{
+    std::cout << "Enter the rulestring to set (e.g. B3/S23, B2-a/S12 or R2,C2,S6-9,B7-8,NM): ";
+    std::string rulestring = "";
+    std::cin >> rulestring;
+
+    return CompileRulestring(rulestring, rules);
+}
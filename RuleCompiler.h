@@ -0,0 +1,15 @@
+#pragma once
+#include <string>
+#include "OffsetStruct.h"
+
+// Compiles a rulestring straight into the raw transition table, one 64-bit word at a time
+// Accepted notations (case-insensitive):
+//   B3/S23, B36S23            Outer-totalistic, range 1
+//   B2-a/S12, B3/S2-i34q      Hensel isotropic non-totalistic, range 1
+//   R2,C2,S6-9,B7-8,NM        HROT outer-totalistic, range 1 or 2; NM = Moore, NN = von Neumann,
+//                             M1 counts the centre cell; lists may mix values, a-b and a..b ranges
+// On a malformed rulestring the error is printed, rules is left untouched and false is returned
+bool CompileRulestring(const std::string& rulestring, R2INTRules& rules, int threadCount = 0);
+
+// Prompts for a rulestring on the console and compiles it into rules (blocks, so call it off the UI thread)
+bool SetRuleFromRulestring(R2INTRules& rules);
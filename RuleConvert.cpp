@@ -0,0 +1,26 @@
+// Converts rule files between the text (.r2int) and binary (.r2bin) formats, and diffs them by isotropic class
+// Built by CMakeLists.txt (target R2INTConvert) rather than R2INT.sln, since it has its own main()
+
+#include <iostream>
+#include <string>
+#include "R2INT_File.h"
+
+int main(int argc, char* argv[])
+{
+    if (argc == 4 && std::string(argv[1]) == "--diff")
+        return DiffRuleFiles(argv[2], argv[3]) ? 0 : 1;
+
+    if (argc != 3 || HasR2binExtension(argv[1]) == HasR2binExtension(argv[2]))
+    {
+        std::cout << "Usage: R2INTConvert INPUT OUTPUT\n"
+            << "  Converts between .r2int and .r2bin; the direction follows the extensions\n"
+            << "       R2INTConvert --diff OLD NEW\n"
+            << "  Lists the isotropic classes that differ between two rule files of either format\n";
+        return 1;
+    }
+
+    bool converted = HasR2binExtension(argv[2])
+        ? ConvertR2intToR2bin(argv[1], argv[2])
+        : ConvertR2binToR2int(argv[1], argv[2]);
+    return converted ? 0 : 1;
+}
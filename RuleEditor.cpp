@@ -1,11 +1,15 @@
 // RuleEditor.cpp
 #include "RuleEditor.h"
+#include "IsotropicRules.h"
 #include "R2INT_File.h"
+#include "RuleCompiler.h"
 #include <SFML/Graphics.hpp>
 #include <SFML/Window.hpp>
 #include "gui.h"
+#include <chrono>
 #include <random>
 #include <iostream>
+#include <thread>
 
 // Grid parameters
 const int rows = 5;
@@ -17,6 +21,20 @@ const float startY = 72.f;   // top-left y
 const float spacingX = 72.f; // horizontal spacing
 const float spacingY = 24.f; // vertical spacing
 
+// Isotropic classes the Mutate button flips
+#define RULE_EDITOR_MUTATIONS 16
+
+// Runs job on a detached thread; unlike std::async, dropping the future doesn't wait for it,
+// so quitting while a console prompt is open doesn't hang
+template <typename Job>
+static auto RunInBackground(Job job) -> std::future<decltype(job())>
+{
+    std::packaged_task<decltype(job())()> task(std::move(job));
+    auto future = task.get_future();
+    std::thread(std::move(task)).detach();
+    return future;
+}
+
 RuleEditor::RuleEditor(std::mt19937& gen, const sf::Font& font, R2INTRules& globalRule)
     : clearText(font, "Clear Rule", 48),
     saveText(font, "Save Rule", 48),
@@ -57,15 +75,103 @@ RuleEditor::RuleEditor(std::mt19937& gen, const sf::Font& font, R2INTRules& glob
         screen = 0;
         });
     settingsMenu.SetButtonCallback(1, [this, &globalRule]() {
-        SaveTor2intFile(globalRule);
+        if (!BackgroundJobRunning())
+        {
+            auto copy = std::make_shared<const R2INTRules>(globalRule);
+            pendingSave = RunInBackground([copy]() {
+                return SaveRuleFile(*copy, AskForRuleFilename("save your rule to"));
+                });
+        }
+        screen = 0;
+        });
+    settingsMenu.SetButtonCallback(2, [this]() {
+        if (!BackgroundJobRunning())
+        {
+            pendingRule = RunInBackground([]() {
+                auto rule = std::make_unique<R2INTRules>();
+                if (!LoadRuleFile(*rule, AskForRuleFilename("load your rule from")))
+                    rule.reset();
+                return rule;
+                });
+        }
+        screen = 0;
+        });
+    settingsMenu.SetButtonCallback(3, [this]() {
+        if (!BackgroundJobRunning())
+        {
+            pendingRule = RunInBackground([]() {
+                auto rule = std::make_unique<R2INTRules>();
+                if (!SetRuleFromRulestring(*rule))
+                    rule.reset();
+                return rule;
+                });
+        }
+        screen = 0;
+        });
+
+    // Both work by isotropic class, which needs the class map, so they run in the background too
+    // They draw their seed here, since the generator belongs to the UI thread
+    settingsMenu.SetButtonCallback(4, [this, &gen]() {
+        if (!BackgroundJobRunning())
+        {
+            uint32_t seed = gen();
+            pendingRule = RunInBackground([seed]() {
+                std::mt19937 jobGen(seed);
+                IsotropicR2INTRules classes;
+                classes.Randomize(jobGen);
+
+                auto rule = std::make_unique<R2INTRules>();
+                classes.ExpandTo(*rule);
+                std::cout << "Random rule with " << classes.CountSet() << " isotropic classes on." << std::endl;
+                return rule;
+                });
+        }
         screen = 0;
         });
-    settingsMenu.SetButtonCallback(2, [this, &globalRule]() {
-        LoadFromr2intFile(globalRule);
+    settingsMenu.SetButtonCallback(5, [this, &gen, &globalRule]() {
+        if (!BackgroundJobRunning())
+        {
+            uint32_t seed = gen();
+            auto rule = std::make_shared<R2INTRules>(globalRule);
+            pendingRule = RunInBackground([seed, rule]() {
+                std::mt19937 jobGen(seed);
+                auto mutated = std::make_unique<R2INTRules>(*rule);
+                MutateRule(*mutated, jobGen, RULE_EDITOR_MUTATIONS);
+                std::cout << "Mutated " << RULE_EDITOR_MUTATIONS << " isotropic classes." << std::endl;
+                return mutated;
+                });
+        }
         screen = 0;
         });
 }
 
+bool RuleEditor::BackgroundJobRunning()
+{
+    auto Running = [](auto& job) {
+        return job.valid() && job.wait_for(std::chrono::seconds(0)) != std::future_status::ready;
+    };
+
+    if (Running(pendingSave) || Running(pendingRule))
+    {
+        std::cerr << "Still waiting on the last save, load or rule; finish that in the console first.\n";
+        return true;
+    }
+    return false;
+}
+
+void RuleEditor::Update(R2INTRules& globalRule)
+{
+    if (pendingSave.valid() && pendingSave.wait_for(std::chrono::seconds(0)) == std::future_status::ready)
+        pendingSave.get();
+
+    if (pendingRule.valid() && pendingRule.wait_for(std::chrono::seconds(0)) == std::future_status::ready)
+    {
+        std::unique_ptr<R2INTRules> rule = pendingRule.get();
+        if (rule)
+            globalRule.CopyFrom(*rule);
+    }
+}
+
 void RuleEditor::RandomizeNeighborhood(std::mt19937& gen) {
     static std::uniform_int_distribution<int> rnd(0, 7);
 
@@ -177,7 +283,7 @@ void RuleEditor::Draw(sf::RenderWindow* window,
             *window,
             mousePos,
             [](int index, bool hovered) -> sf::Color {
-                if (index <= 2) {
+                if (index <= 5) {
                     return hovered
                         ? sf::Color(40, 200, 120)
                         : sf::Color(100, 255, 170);
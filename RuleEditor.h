@@ -4,6 +4,8 @@
 #include <SFML/Graphics.hpp>
 #include <SFML/Window.hpp>
 #include <array>
+#include <future>
+#include <memory>
 #include <random>
 #include "OffsetStruct.h"  // For Neighborhood type and methods
 #include "Menu.hpp"
@@ -16,6 +18,9 @@ public:
     void SetScreen(short int s) { screen = s; };
 
     void RandomizeNeighborhood(std::mt19937& gen);
+
+    // Hands a rule that finished loading or compiling in the background to globalRule; call once per frame
+    void Update(R2INTRules& globalRule);
     void HandleEvent(const sf::Event& event,
         R2INTRules& globalRule,
         std::mt19937& gen,
@@ -40,4 +45,11 @@ private:
     Menu settingsMenu;
 
     short int screen = 0; // 0 = main editor, 1 = settings
+
+    // Save, Load and Set Rule prompt on the console and touch the disk, and Rand Rule and Mutate need the class map,
+    // so they run on background threads
+    // Saves work on a copy of the rule; the others build a new one that Update() copies in once it's ready
+    bool BackgroundJobRunning();
+    std::future<bool> pendingSave;
+    std::future<std::unique_ptr<R2INTRules>> pendingRule;
 };
\ No newline at end of file
@@ -0,0 +1,273 @@
+#include "SimulationThread.h"
+
+// How far behind schedule the simulation may fall before it stops trying to catch up
+#define SIMULATION_MAX_LAG std::chrono::milliseconds(250)
+
+// How often the measured generation rate is refreshed
+#define SIMULATION_RATE_INTERVAL std::chrono::milliseconds(500)
+
+SimulationThread::SimulationThread(const World& initialWorld, const R2INTRules& rules)
+    : world(initialWorld),
+    rule(std::make_shared<const R2INTRules>(rules)),
+    snapshot(std::make_shared<const World>(initialWorld))
+{
+    thread = std::thread(&SimulationThread::Run, this);
+}
+
+SimulationThread::~SimulationThread()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_one();
+    thread.join();
+}
+
+void SimulationThread::Post(std::function<void(World&)> command)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        commands.push_back(std::move(command));
+    }
+    wake.notify_one();
+}
+
+void SimulationThread::ReplaceWorld(const World& replacement)
+{
+    Post([this, replacement](World& w) {
+        int engine = w.Engine;
+        int hashLifeStep = w.HashLifeStep;
+        int threadCount = w.ThreadCount;
+
+        w = replacement;
+        w.Engine = engine;
+        w.HashLifeStep = hashLifeStep;
+        w.ThreadCount = threadCount;
+        strideLeft = 0; // The rest of the step belonged to the old pattern
+        });
+}
+
+void SimulationThread::SetRule(const R2INTRules& rules)
+{
+    auto copy = std::make_shared<const R2INTRules>(rules);
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        pendingRule = std::move(copy);
+    }
+    wake.notify_one();
+}
+
+void SimulationThread::SetPlaying(bool isPlaying)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (isPlaying && !playing)
+            nextStep = Clock::now();
+        if (!isPlaying)
+            generationsPerSecond = 0.0;
+        playing = isPlaying;
+    }
+    wake.notify_one();
+}
+
+void SimulationThread::SetMaxSpeed(bool isMaxSpeed)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!isMaxSpeed && maxSpeed)
+            nextStep = Clock::now();
+        maxSpeed = isMaxSpeed;
+    }
+    wake.notify_one();
+}
+
+void SimulationThread::SetFrameBudget(int milliseconds)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    frameBudgetMs = milliseconds;
+}
+
+void SimulationThread::SetStepExponent(int exponent)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    stepExponent = exponent;
+}
+
+double SimulationThread::GenerationsPerSecond()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return generationsPerSecond;
+}
+
+void SimulationThread::SetTimeStep(float seconds)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    timeStep = seconds;
+}
+
+void SimulationThread::Step()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        pendingSteps++;
+    }
+    wake.notify_one();
+}
+
+std::shared_ptr<const World> SimulationThread::Snapshot()
+{
+    std::shared_ptr<const World> latest;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        latest = snapshot;
+        snapshotTaken = true;
+    }
+    wake.notify_one(); // The simulation may be waiting to publish
+    return latest;
+}
+
+bool SimulationThread::Interrupted()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return stopping || !commands.empty() || pendingRule;
+}
+
+void SimulationThread::AdvanceStride(Clock::time_point deadline)
+{
+    // Always makes progress, then stops at the deadline or as soon as the UI wants something,
+    // leaving the rest of the stride for the next pass
+    do
+    {
+        if (world.Engine == ENGINE_HASHLIFE && world.CanJump(*rule))
+        {
+            // The whole stride in one jump, or what an interrupted one has left in power of two pieces
+            int exponent = 0;
+            while ((int64_t(2) << exponent) <= strideLeft)
+                exponent++;
+            world.Jump(*rule, exponent);
+            strideLeft -= int64_t(1) << exponent;
+        }
+        else
+        {
+            world.StepChunks(*rule);
+            strideLeft--;
+        }
+    } while (strideLeft > 0 && Clock::now() < deadline && !Interrupted());
+}
+
+void SimulationThread::Run()
+{
+    bool dirty = false; // The world changed since the last snapshot
+
+    // Generation rate, measured over SIMULATION_RATE_INTERVAL
+    Clock::time_point rateStart = Clock::now();
+    int64_t rateGeneration = world.Generation;
+
+    for (;;)
+    {
+        std::vector<std::function<void(World&)>> batch;
+        bool step = false;       // Start a new stride
+        bool batchSteps = false; // Keep starting strides until the budget runs out
+        int exponent = 0;
+        Clock::duration budget;
+        bool publish = false;
+
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+
+            auto HasWork = [&]() {
+                return stopping || strideLeft > 0 || !commands.empty() || pendingRule || pendingSteps > 0 ||
+                    (playing && (maxSpeed || Clock::now() >= nextStep)) || (dirty && snapshotTaken);
+            };
+            if (playing && !maxSpeed)
+                wake.wait_until(lock, nextStep, HasWork);
+            else
+                wake.wait(lock, HasWork);
+
+            if (stopping)
+                return;
+
+            batch.swap(commands);
+            if (pendingRule)
+                rule = std::move(pendingRule);
+
+            exponent = stepExponent;
+            budget = std::chrono::milliseconds(frameBudgetMs);
+
+            if (strideLeft > 0)
+            {
+                // Finish the stride the budget or a command cut short before starting another
+                batchSteps = playing && maxSpeed;
+            }
+            else if (pendingSteps > 0)
+            {
+                pendingSteps--;
+                step = true;
+            }
+            else if (playing && maxSpeed)
+            {
+                step = true;
+                batchSteps = true;
+            }
+            else if (playing && Clock::now() >= nextStep)
+            {
+                step = true;
+                nextStep += std::chrono::duration_cast<Clock::duration>(std::chrono::duration<float>(timeStep));
+
+                // Drop generations we can't keep up with instead of piling them up
+                if (Clock::now() - nextStep > SIMULATION_MAX_LAG)
+                    nextStep = Clock::now();
+            }
+        }
+
+        for (auto& command : batch)
+            command(world);
+        if (!batch.empty())
+            dirty = true;
+
+        if (step || strideLeft > 0)
+        {
+            // Strides run one generation at a time within the budget; only finished ones are published
+            Clock::time_point deadline = Clock::now() + budget;
+            for (;;)
+            {
+                if (strideLeft == 0)
+                    strideLeft = int64_t(1) << exponent;
+                AdvanceStride(deadline);
+                if (strideLeft > 0)
+                    break;
+                dirty = true;
+                if (!batchSteps || Clock::now() >= deadline || Interrupted())
+                    break;
+            }
+        }
+
+        Clock::time_point now = Clock::now();
+        bool updateRate = now - rateStart >= SIMULATION_RATE_INTERVAL;
+        double rate = 0.0;
+        if (updateRate)
+        {
+            rate = (world.Generation - rateGeneration) / std::chrono::duration<double>(now - rateStart).count();
+            rateStart = now;
+            rateGeneration = world.Generation;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            publish = dirty && snapshotTaken && strideLeft == 0; // Never a generation in the middle of a stride
+            if (updateRate && playing)
+                generationsPerSecond = rate;
+        }
+
+        if (publish)
+        {
+            auto copy = std::make_shared<const World>(world);
+
+            std::lock_guard<std::mutex> lock(mutex);
+            snapshot = std::move(copy);
+            snapshotTaken = false;
+            dirty = false;
+        }
+    }
+}
@@ -0,0 +1,77 @@
+#pragma once
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "OffsetStruct.h"
+#include "World.h"
+
+// Default time a max speed batch may run before commands and snapshots are serviced again
+#define SIMULATION_FRAME_BUDGET_MS 14
+
+// Runs a World on its own thread
+// The UI never touches the live World: it draws the latest published snapshot and sends edits as commands,
+// so a slow generation can't block input or drawing, and a fast rule isn't capped by the frame rate
+// A new snapshot is only copied once the previous one has been taken, so at most one per frame
+class SimulationThread {
+public:
+    SimulationThread(const World& world, const R2INTRules& rules);
+    ~SimulationThread();
+
+    SimulationThread(const SimulationThread&) = delete;
+    SimulationThread& operator=(const SimulationThread&) = delete;
+
+    // Commands run on the simulation thread, in order, before its next generation
+    void Post(std::function<void(World&)> command);
+    void ReplaceWorld(const World& replacement); // Keeps the engine settings, which belong to the simulation rather than the pattern
+    void SetRule(const R2INTRules& rules);       // Copies the rule, so the caller can keep editing its own
+    void SetPlaying(bool playing);
+    void SetTimeStep(float seconds);             // Time between generations while playing
+    void Step();                                 // One step, whether playing or not
+
+    // Max speed ignores the time step and runs steps back to back, in batches of up to the frame budget
+    void SetMaxSpeed(bool maxSpeed);
+    void SetFrameBudget(int milliseconds);
+
+    // Every step advances 2^exponent generations, and only those generations are published
+    // (HashLife jumps them in one go; the chunk engine steps them one at a time, servicing commands in between)
+    void SetStepExponent(int exponent);
+
+    double GenerationsPerSecond();
+
+    // Latest published state; stays valid for as long as the caller holds on to it
+    std::shared_ptr<const World> Snapshot();
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    void Run();
+    void AdvanceStride(Clock::time_point deadline);
+    bool Interrupted(); // Something is waiting for the simulation thread to get back to its loop
+
+    World world;                            // Only touched by the simulation thread
+    std::shared_ptr<const R2INTRules> rule; // Likewise
+    int64_t strideLeft = 0;                 // Likewise; generations left in the current step
+
+    // Everything below is guarded by mutex
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::vector<std::function<void(World&)>> commands;
+    std::shared_ptr<const R2INTRules> pendingRule;
+    std::shared_ptr<const World> snapshot;
+    bool snapshotTaken = false;
+    bool playing = false;
+    bool maxSpeed = false;
+    int frameBudgetMs = SIMULATION_FRAME_BUDGET_MS;
+    int stepExponent = 0;
+    float timeStep = 1.0f / 60.0f;
+    double generationsPerSecond = 0.0;
+    Clock::time_point nextStep;
+    int pendingSteps = 0;
+    bool stopping = false;
+
+    std::thread thread;
+};
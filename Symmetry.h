@@ -0,0 +1,140 @@
+#pragma once
+#include <array>
+#include <cstdint>
+
+//
+// Symmetries of packed transitions
+// A transition packs a 5x5 neighborhood into 25 bits with n[k] at bit 24 - k, so row r is the 5-bit group
+// at bit 20 - 5r, with column 0 as its high bit
+// Every transform moves whole rows through 32-entry tables instead of round-tripping through a Neighborhood,
+// and everything is constexpr, so canonical forms can be computed at compile time or in tight loops
+//
+
+constexpr int TransitionRow(int Transition, int Row)
+{
+    return (Transition >> (20 - 5 * Row)) & 31;
+}
+
+// Row with its 5 bits reversed
+constexpr std::array<uint8_t, 32> BuildRowReversal()
+{
+    std::array<uint8_t, 32> table{};
+    for (int v = 0; v < 32; v++)
+    {
+        int reversed = 0;
+        for (int c = 0; c < 5; c++)
+            reversed |= ((v >> c) & 1) << (4 - c);
+        table[v] = static_cast<uint8_t>(reversed);
+    }
+    return table;
+}
+
+// Bits row r with value v occupies once transposed, i.e. as column r
+constexpr std::array<std::array<uint32_t, 32>, 5> BuildTransposeRows()
+{
+    std::array<std::array<uint32_t, 32>, 5> table{};
+    for (int r = 0; r < 5; r++)
+    {
+        for (int v = 0; v < 32; v++)
+        {
+            uint32_t bits = 0;
+            for (int c = 0; c < 5; c++)
+            {
+                if ((v >> (4 - c)) & 1)
+                    bits |= uint32_t(1) << (24 - (5 * c + r));
+            }
+            table[r][v] = bits;
+        }
+    }
+    return table;
+}
+
+inline constexpr std::array<uint8_t, 32> RowReversal = BuildRowReversal();
+inline constexpr std::array<std::array<uint32_t, 32>, 5> TransposeRows = BuildTransposeRows();
+
+// Left <-> right
+constexpr int MirrorTransitionHorizontally(int Transition)
+{
+    int result = 0;
+    for (int r = 0; r < 5; r++)
+        result |= RowReversal[TransitionRow(Transition, r)] << (20 - 5 * r);
+    return result;
+}
+
+// Top <-> bottom
+constexpr int MirrorTransitionVertically(int Transition)
+{
+    int result = 0;
+    for (int r = 0; r < 5; r++)
+        result |= TransitionRow(Transition, r) << (5 * r);
+    return result;
+}
+
+// Across the main diagonal
+constexpr int TransposeTransition(int Transition)
+{
+    uint32_t result = 0;
+    for (int r = 0; r < 5; r++)
+        result |= TransposeRows[r][TransitionRow(Transition, r)];
+    return static_cast<int>(result);
+}
+
+constexpr int RotateTransitionCW(int Transition)
+{
+    return MirrorTransitionHorizontally(TransposeTransition(Transition));
+}
+
+constexpr int RotateTransitionCCW(int Transition)
+{
+    return MirrorTransitionVertically(TransposeTransition(Transition));
+}
+
+// All 8 images under rotation and reflection, in the order FindAllIsotropicNeighborhoodValues has always given them:
+// the 4 counterclockwise rotations, then the 4 counterclockwise rotations of the horizontal mirror
+// (GetAllSymmetries keeps its own order: r0, CW, CCW, 180, then the horizontal mirror of each)
+constexpr std::array<int, 8> TransitionSymmetries(int Transition)
+{
+    int h = MirrorTransitionHorizontally(Transition);
+    int v = MirrorTransitionVertically(Transition);
+    int t = TransposeTransition(Transition);
+    int hv = MirrorTransitionVertically(h);
+    int ht = MirrorTransitionHorizontally(t);
+    int vt = MirrorTransitionVertically(t);
+    int hvt = MirrorTransitionVertically(ht);
+
+    return { Transition, vt, hv, ht, h, t, v, hvt };
+}
+
+// Lowest transition of the isotropic class, which represents it
+constexpr int CanonicalTransition(int Transition)
+{
+    int lowest = Transition;
+    for (int s : TransitionSymmetries(Transition))
+    {
+        if (s < lowest)
+            lowest = s;
+    }
+    return lowest;
+}
+
+// Same as CanonicalTransition(Transition) == Transition, but gives up at the first lower image
+constexpr bool IsCanonicalTransition(int Transition)
+{
+    int h = MirrorTransitionHorizontally(Transition);
+    if (h < Transition)
+        return false;
+    int v = MirrorTransitionVertically(Transition);
+    if (v < Transition || MirrorTransitionVertically(h) < Transition)
+        return false;
+
+    int t = TransposeTransition(Transition);
+    if (t < Transition)
+        return false;
+    int ht = MirrorTransitionHorizontally(t);
+    return ht >= Transition && MirrorTransitionVertically(t) >= Transition && MirrorTransitionVertically(ht) >= Transition;
+}
+
+static_assert(RotateTransitionCW(1 << 24) == 1 << 20, "Top-left corner rotates to the top-right");
+static_assert(RotateTransitionCCW(RotateTransitionCW(0x1234567)) == 0x1234567, "Rotations are inverses");
+static_assert(TransitionSymmetries(1 << 24)[1] == 1 << 4 && TransitionSymmetries(1 << 24)[3] == 1 << 20, "Rotations run counterclockwise");
+static_assert(CanonicalTransition(1) == 1 && CanonicalTransition(1 << 24) == 1, "Corners share a class");
@@ -0,0 +1,95 @@
+#include "ThreadPool.h"
+#include <memory>
+
+ThreadPool::ThreadPool(int threadCount)
+{
+    for (int i = 1; i < threadCount; i++)
+        workers.emplace_back(&ThreadPool::WorkerLoop, this);
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+
+    for (std::thread& worker : workers)
+        worker.join();
+}
+
+void ThreadPool::RunJob()
+{
+    int i;
+    while ((i = nextIndex.fetch_add(1)) < jobCount)
+        (*job)(i);
+}
+
+void ThreadPool::ParallelFor(int count, const std::function<void(int)>& body)
+{
+    if (workers.empty() || count <= 1)
+    {
+        for (int i = 0; i < count; i++)
+            body(i);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        job = &body;
+        jobCount = count;
+        nextIndex = 0;
+        pendingWorkers = static_cast<int>(workers.size());
+        jobId++;
+    }
+    wake.notify_all();
+
+    RunJob();
+
+    std::unique_lock<std::mutex> lock(mutex);
+    done.wait(lock, [this]() { return pendingWorkers == 0; });
+    job = nullptr;
+}
+
+void ThreadPool::WorkerLoop()
+{
+    uint64_t seenJob = 0;
+
+    for (;;)
+    {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [&]() { return stopping || jobId != seenJob; });
+            if (stopping)
+                return;
+            seenJob = jobId;
+        }
+
+        RunJob();
+
+        std::lock_guard<std::mutex> lock(mutex);
+        if (--pendingWorkers == 0)
+            done.notify_one();
+    }
+}
+
+int ThreadPool::ResolveThreadCount(int threadCount)
+{
+    if (threadCount > 0)
+        return threadCount;
+
+    int hardware = static_cast<int>(std::thread::hardware_concurrency());
+    return hardware > 0 ? hardware : 1;
+}
+
+ThreadPool& ThreadPool::Shared(int threadCount)
+{
+    static std::unique_ptr<ThreadPool> pool;
+
+    int resolved = ResolveThreadCount(threadCount);
+    if (!pool || pool->ThreadCount() != resolved)
+        pool = std::make_unique<ThreadPool>(resolved);
+
+    return *pool;
+}
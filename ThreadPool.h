@@ -0,0 +1,45 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Persistent worker threads for splitting a generation's work across cores
+// The calling thread takes part in every ParallelFor, so ThreadCount() includes it
+class ThreadPool {
+public:
+    explicit ThreadPool(int threadCount);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    int ThreadCount() const { return static_cast<int>(workers.size()) + 1; }
+
+    // Runs body(i) for every i in [0, count) and returns once all of them are done
+    // Indices are handed out dynamically, so the order of calls is unspecified
+    void ParallelFor(int count, const std::function<void(int)>& body);
+
+    // Shared pool, rebuilt when a different thread count is requested (0 = all hardware threads)
+    static ThreadPool& Shared(int threadCount);
+    static int ResolveThreadCount(int threadCount);
+
+private:
+    void WorkerLoop();
+    void RunJob();
+
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable done;
+
+    const std::function<void(int)>* job = nullptr;
+    int jobCount = 0;
+    std::atomic<int> nextIndex{ 0 };
+    int pendingWorkers = 0;
+    uint64_t jobId = 0;
+    bool stopping = false;
+};
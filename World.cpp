@@ -1,13 +1,11 @@
 #include "World.h"
+#include "ThreadPool.h"
+#include <cctype>
+#include <fstream>
 #include <iostream>
 
-//#define DEBUG_BG
-
 World::World() : rng(std::random_device{}()) {
-    Chunk initial;
-    initial.CoordinateX = 0;
-    initial.CoordinateY = 0;
-    contents[{0, 0}] = initial;
+    contents.Insert({ 0, 0 });
 }
 
 void World::PaintAtCell(sf::Vector2i p, int newState)
@@ -23,26 +21,31 @@ void World::PaintAtCell(sf::Vector2i p, int newState)
     GridCoord coord = { gx, gy };
 
     // Get or create the grid
-    auto& grid = contents[coord];
-    grid.CoordinateX = gx;
-    grid.CoordinateY = gy;
+    Chunk& grid = contents.Insert(coord);
 
-    int oldState = grid.Grid[lx][ly];
+    int oldState = grid.GetCell(lx, ly, Parity);
 
     // Paint the cell
-    grid.Grid[lx][ly] = newState;
-    grid.OldGrid[lx][ly] = newState;
+    grid.SetCell(lx, ly, newState);
 
     // Update Fill count
     grid.Fill += (newState - oldState);
 
     // Remove the chunk if it is empty after erasing
     if (newState == 0 && grid.Fill == 0) {
-        contents.erase(coord);
+        contents.Erase(coord);
+
+        // Neighbors may have been skipping while reading the cells that were just erased
+        for (int dy = -1; dy <= 1; ++dy) {
+            for (int dx = -1; dx <= 1; ++dx) {
+                if (Chunk* neighbor = contents.Find({ gx + dx, gy + dy }))
+                    neighbor->ForceStep = true;
+            }
+        }
     }
 }
 
-__int8 World::GetCellStateAt(sf::Vector2i p) const
+int8_t World::GetCellStateAt(sf::Vector2i p) const
 {
     // Determine which grid the cell is in
     int gx = (p.x >= 0) ? p.x / GRID_DIMENSIONS : (p.x - GRID_DIMENSIONS + 1) / GRID_DIMENSIONS;
@@ -54,202 +57,153 @@ __int8 World::GetCellStateAt(sf::Vector2i p) const
 
     GridCoord coord = { gx, gy };
 
-    auto it = contents.find(coord);
-    if (it != contents.end())
-        return it->second.Grid[lx][ly];
+    if (const Chunk* grid = contents.Find(coord))
+        return grid->GetCell(lx, ly, Parity);
 
     // Default background state (flickers with B0)
     return VoidState;
 }
 
-__int8 World::GetCellStateAtOld(sf::Vector2i p) const
+void World::Simulate(const R2INTRules& Rules) {
+    if (Engine == ENGINE_HASHLIFE && Jump(Rules, HashLifeStep))
+        return;
+    StepChunks(Rules);
+}
+
+bool World::CanJump(const R2INTRules& Rules) const
 {
-    // Determine which grid the cell is in
-    int gx = (p.x >= 0) ? p.x / GRID_DIMENSIONS : (p.x - GRID_DIMENSIONS + 1) / GRID_DIMENSIONS;
-    int gy = (p.y >= 0) ? p.y / GRID_DIMENSIONS : (p.y - GRID_DIMENSIONS + 1) / GRID_DIMENSIONS;
+    return VoidState == 0 && HashLifeUniverse::SupportsRule(Rules);
+}
 
-    // Local cell coordinates within the grid
-    int lx = p.x - gx * GRID_DIMENSIONS;
-    int ly = p.y - gy * GRID_DIMENSIONS;
+bool World::Jump(const R2INTRules& Rules, int exponent)
+{
+    // The quadtree needs an empty background, so B0 rules (and a full void) are left to the caller,
+    // which steps them chunk by chunk and can stop between generations
+    if (!CanJump(Rules))
+        return false;
+
+    if (!hashLife)
+        hashLife = std::make_shared<HashLifeUniverse>();
+
+    hashLife->SetRule(Rules);
+    hashLife->Load(contents, Parity);
+    hashLife->Step(exponent);
+    hashLife->Store(contents);
+
+    // Stored chunks hold the result in both buffers and have no history to skip on
+    Parity = 0;
+    LastRule = nullptr;
+    PreviousVoidStates[0] = 0;
+    PreviousVoidStates[1] = 0;
+
+    Generation += int64_t(1) << exponent;
+    return true;
+}
 
-    GridCoord coord = { gx, gy };
+void World::StepChunks(const R2INTRules& Rules) {
+    // Step 1: Ensure needed neighbors exist
+    // Chunks keep their addresses, but inserting invalidates iteration, so walk a copy of the list
+    std::vector<Chunk*> grids;
+    grids.reserve(contents.Size());
+    for (Chunk& grid : contents)
+        grids.push_back(&grid);
 
-    auto it = contents.find(coord);
-    if (it != contents.end())
-        return it->second.OldGrid[lx][ly];
+    for (Chunk* grid : grids)
+        EnsureNeighborsExist(*this, *grid);
 
-    // Default background state
-    return VoidState;
-}
+    // Step 3: Step in Z-order to keep neighboring chunks together; neighborGrids is already linked by ChunkMap
+    contents.SortSpatially();
 
-void World::LinkAllNeighbors()
-{
-    for (auto& [coord, grid] : contents)
-    {
-        for (int dy = -1; dy <= 1; ++dy)
-        {
-            for (int dx = -1; dx <= 1; ++dx)
-            {
-                GridCoord neighborCoord = { coord.x + dx, coord.y + dy };
+    // Step 4: Pick the chunks that need stepping; the rest already hold their next generation
+    bool stepAll = &Rules != LastRule || Rules.Version != LastRuleVersion || VoidState != PreviousVoidStates[1];
+    LastRule = &Rules;
+    LastRuleVersion = Rules.Version;
 
-                auto it = contents.find(neighborCoord);
-                if (it != contents.end())
-                {
-                    grid.neighborGrids[dx + 1][dy + 1] = &it->second;
-                }
-                else
-                {
-                    grid.neighborGrids[dx + 1][dy + 1] = nullptr;
-                }
-            }
-        }
+    if (&Rules != AnalyzedRule || Rules.Version != AnalyzedRuleVersion)
+    {
+        Totalistic = AnalyzeTotalistic(Rules);
+        Shaped = Totalistic.Range ? nullptr : BuildShapedRule(Rules);
+        AnalyzedRule = &Rules;
+        AnalyzedRuleVersion = Rules.Version;
     }
-}
 
-void World::Simulate(const R2INTRules& Rules) {
-    // Step 1: Ensure needed neighbors exist
-    std::vector<GridCoord> keys;
-    keys.reserve(contents.size());
-    for (const auto& [coord, grid] : contents)
-        keys.push_back(coord);
-
-    for (const GridCoord& coord : keys) {
-        Chunk& grid = contents.at(coord);
-        EnsureNeighborsExist(*this, grid);
+    std::vector<Chunk*> chunks;
+    chunks.reserve(contents.Size());
+    for (Chunk& grid : contents) {
+        if (stepAll || grid.NeedsStep())
+            chunks.push_back(&grid);
+        else
+            grid.SkipStep();
+        grid.ForceStep = false;
     }
+    ActiveChunks = static_cast<int>(chunks.size());
 
-    // Step 3: Relink neighbors after changes
-    LinkAllNeighbors();
-
-    // Step 4: Simulate all grids safely
-    keys.clear();
-    for (const auto& [coord, grid] : contents)
-        keys.push_back(coord);
+    // Step 5: Simulate all grids safely
+    // Chunks only read their neighbors' current buffer and write their own other buffer, so they can run in parallel
 
-    for (const GridCoord& coord : keys) {
-        Chunk& grid = contents.at(coord);
-        grid.Simulate(Rules, *this);
-    }
+    ThreadPool::Shared(ThreadCount).ParallelFor(static_cast<int>(chunks.size()), [&](int i) {
+        chunks[i]->Simulate(Rules, *this);
+        });
 
     // Simulate the VoidState under the rules for B0 handling
+    PreviousVoidStates[1] = PreviousVoidStates[0];
+    PreviousVoidStates[0] = VoidState;
     VoidState = ApplyRules(VoidState == 1 ? 33554431 : 0, Rules) ? 1 : 0;
 
-    for (const GridCoord& coord : keys) {
-        Chunk& grid = contents.at(coord);
-        grid.ResetOld();
-    }
-
+    // The buffers every chunk just wrote become the current generation
+    Parity ^= 1;
 
     // Save DeleteEmptyGrids for last to prevent issues during simulation
     DeleteEmptyGrids(contents, VoidState);
 
     Generation++;
 
-    //std::cout << "[DEBUG] Number of grids after simulation: " << contents.size() << std::endl;
+    //std::cout << "[DEBUG] Number of grids after simulation: " << contents.Size() << std::endl;
 }
 
 Chunk* World::GetNeighborGrid(int x, int y) {
     GridCoord coord = { x, y };
 
-    // Check if the neighbor grid exists in the map
-    auto it = contents.find(coord);
-    if (it != contents.end()) {
-        return &it->second;  // Return the existing grid
-    }
-
-    // If it doesn't exist, create and link the new grid
-    Chunk newGrid(coord.x, coord.y);
-    contents[coord] = newGrid;
-
-    return &contents[coord];
+    // Return the existing grid, or create it if it doesn't exist
+    return &contents.Insert(coord);
 }
 
 void World::EnsureAllPotentialNeighborGridsExist() {
     std::vector<GridCoord> currentKeys;
-    for (const auto& [coord, _] : contents)
-        currentKeys.push_back(coord);
+    for (const Chunk& grid : contents)
+        currentKeys.push_back({ grid.CoordinateX, grid.CoordinateY });
 
     for (const auto& coord : currentKeys) {
         for (int dy = -1; dy <= 1; ++dy) {
             for (int dx = -1; dx <= 1; ++dx) {
                 GridCoord neighborCoord = { coord.x + dx, coord.y + dy };
-                if (contents.find(neighborCoord) == contents.end()) {
-                    Chunk& newGrid = contents[neighborCoord];
-                    newGrid.CoordinateX = neighborCoord.x;
-                    newGrid.CoordinateY = neighborCoord.y;
-                }
+                contents.Insert(neighborCoord);
             }
         }
     }
 }
 
 
-void DeleteEmptyGrids(std::unordered_map<GridCoord, Chunk>& worldMap, __int8 VoidState) {
-    for (auto it = worldMap.begin(); it != worldMap.end(); ) {
-        if ((it->second.Fill == 0 && VoidState == 0) || (it->second.Fill == 4096 && VoidState == 1)) {
-            it = worldMap.erase(it);
-        }
-        else {
-            ++it;
-        }
-    }
-}
-
-// Draw
-void World::Draw(sf::RenderWindow& window, const std::vector<sf::Color>& colors)
-{
-    size_t totalGrids = contents.size();
-    sf::VertexArray vertexArray(sf::PrimitiveType::Triangles, totalGrids * GRID_DIMENSIONS * GRID_DIMENSIONS * 6);
-
-    size_t vertexIndex = 0;
-
-    for (const auto& entry : contents) {
-        const GridCoord& gridCoord = entry.first;
-        const Chunk& gridData = entry.second;
-
-        float offsetX = gridCoord.x * GRID_DIMENSIONS * cellSize;
-        float offsetY = gridCoord.y * GRID_DIMENSIONS * cellSize;
-
-#ifdef DEBUG_BG
-        // Deterministic debug background color
-        std::size_t hashValue = std::hash<int>()(gridCoord.x) ^ (std::hash<int>()(gridCoord.y) << 1);
-        unsigned char bgR = static_cast<unsigned char>((hashValue & 0xFF) % 32);
-        unsigned char bgG = static_cast<unsigned char>(((hashValue >> 8) & 0xFF) % 32);
-        unsigned char bgB = static_cast<unsigned char>(((hashValue >> 16) & 0xFF) % 32);
-        sf::Color gridBgColor(bgR, bgG, bgB);
-#else
-        sf::Color gridBgColor(0, 0, 0); // Release build fixed background
-#endif
-
-        for (int i = 0; i < GRID_DIMENSIONS; i++) {
-            for (int j = 0; j < GRID_DIMENSIONS; j++) {
-                float x = offsetX + i * cellSize;
-                float y = offsetY + j * cellSize;
-
-                __int8 cellState = GetCellStateAt({
-                    gridCoord.x * GRID_DIMENSIONS + i,
-                    gridCoord.y * GRID_DIMENSIONS + j
-                    });
-
-                sf::Color color = (cellState == 0) ? gridBgColor : colors[cellState];
-
-                // First triangle
-                vertexArray[vertexIndex++].position = sf::Vector2f(x, y);
-                vertexArray[vertexIndex++].position = sf::Vector2f(x, y + cellSize);
-                vertexArray[vertexIndex++].position = sf::Vector2f(x + cellSize, y);
-
-                // Second triangle
-                vertexArray[vertexIndex++].position = sf::Vector2f(x + cellSize, y);
-                vertexArray[vertexIndex++].position = sf::Vector2f(x, y + cellSize);
-                vertexArray[vertexIndex++].position = sf::Vector2f(x + cellSize, y + cellSize);
-
-                for (int k = 0; k < 6; k++)
-                    vertexArray[vertexIndex - 6 + k].color = color;
+void DeleteEmptyGrids(ChunkMap& worldMap, int8_t VoidState) {
+    // Wake the neighbors first if the chunk's border was still changing; they can't see its ChangedMask once it's gone
+    // Erasing unlinks a chunk, so every empty chunk wakes its neighbors before any of them is erased
+    std::vector<GridCoord> emptyGrids;
+    for (Chunk& grid : worldMap) {
+        if ((grid.Fill == 0 && VoidState == 0) || (grid.Fill == 4096 && VoidState == 1)) {
+            emptyGrids.push_back({ grid.CoordinateX, grid.CoordinateY });
+            for (int dy = -1; dy <= 1; ++dy) {
+                for (int dx = -1; dx <= 1; ++dx) {
+                    Chunk* neighbor = grid.neighborGrids[dx + 1][dy + 1];
+                    if (neighbor && neighbor != &grid && (grid.ChangedMask & ChangedBit(dx, dy)))
+                        neighbor->ForceStep = true;
+                }
             }
         }
     }
 
-    window.draw(vertexArray);
+    // Erased chunks go back to the pool for the next chunk that's created
+    for (const GridCoord& coord : emptyGrids)
+        worldMap.Erase(coord);
 }
 
 sf::IntRect World::GetRect() const
@@ -261,9 +215,9 @@ sf::IntRect World::GetRect() const
     int maxRight = 0;
     int maxBottom = 0;
 
-    for (const auto& [coord, chunk] : contents)
+    for (const Chunk& chunk : contents)
     {
-        sf::IntRect r = chunk.GetRect();
+        sf::IntRect r = chunk.GetRect(Parity);
         if (r.size.x < 0 || r.size.y < 0)
             continue; // empty chunk
         int globalLeft = chunk.CoordinateX * GRID_DIMENSIONS + r.position.x;
@@ -298,11 +252,23 @@ sf::IntRect World::GetRect() const
     );
 }
 
+int64_t World::Population() const
+{
+    int64_t population = 0;
+    for (const Chunk& chunk : contents)
+        population += chunk.Fill;
+    return population;
+}
+
 void World::PrintRLE() const
+{
+    std::cout << ToRLE() << std::endl;
+}
+
+std::string World::ToRLE() const
 {
     sf::IntRect rect = GetRect();
-    std::cout << "x = " << rect.size.x << ", y = " << rect.size.y << ", rule = undefined" << std::endl;
-    std::string rle;
+    std::string rle = "x = " + std::to_string(rect.size.x) + ", y = " + std::to_string(rect.size.y) + ", rule = undefined\n";
 
     for (int y = rect.position.y; y < rect.position.y + rect.size.y; y++)
     {
@@ -347,23 +313,69 @@ void World::PrintRLE() const
     }
 
     rle += '!';
-    std::cout << rle << std::endl;
+    return rle;
+}
+
+bool World::LoadRLE(const std::string& path)
+{
+    std::ifstream inFile(path);
+    if (!inFile)
+    {
+        std::cerr << "Error: Could not open " << path << " for reading.\n";
+        return false;
+    }
+
+    contents.Clear();
+    Generation = 0;
+
+    std::string line;
+    int x = 0;
+    int y = 0;
+    int runCount = 0;
+
+    while (std::getline(inFile, line))
+    {
+        if (line.empty() || line[0] == '#' || line[0] == 'x')
+            continue;
+
+        for (char c : line)
+        {
+            if (c >= '0' && c <= '9')
+            {
+                runCount = runCount * 10 + (c - '0');
+                continue;
+            }
+
+            int run = runCount > 0 ? runCount : 1;
+            runCount = 0;
+
+            if (c == '!')
+                return true;
+            else if (c == '$')
+            {
+                y += run;
+                x = 0;
+            }
+            else if (c == 'b' || c == '.')
+                x += run;
+            else if (std::isalpha(static_cast<unsigned char>(c)))
+            {
+                for (int i = 0; i < run; i++)
+                    PaintAtCell({ x++, y }, 1);
+            }
+        }
+    }
+
+    return true;
 }
 
 void World::TestRandomize()
 {
     // 1) Clear all existing chunks
-    contents.clear();
+    contents.Clear();
 
     // 2) Create a single chunk at origin
-    GridCoord origin{ 0, 0 };
-
-    auto [it, inserted] = contents.emplace(
-        origin,
-        Chunk(origin.x, origin.y)
-    );
-
-    Chunk& chunk = it->second;
+    Chunk& chunk = contents.Insert({ 0, 0 });
 
     // 3) Randomize the entire chunk
     sf::Rect<int> fullChunk(
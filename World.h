@@ -1,38 +1,70 @@
 #pragma once
 #include "Chunk.h"
+#include "ChunkMap.h"
+#include "HashLife.h"
+#include "RuleAnalysis.h"
+#include <memory>
+#include <string>
 #include <unordered_map>
 
+// Simulation engines a World can use
+#define ENGINE_CHUNKS 0   // Steps every chunk one generation at a time
+#define ENGINE_HASHLIFE 1 // Jumps 2^HashLifeStep generations per Simulate call (B0 rules step one generation instead)
+
 struct World {
-    std::unordered_map<GridCoord, Chunk> contents;
-    int Generation = 0;
+    ChunkMap contents;
+    int64_t Generation = 0;
     int n_states = 2;
     float cellSize = 40.f;
-    __int8 VoidState = 0; // Default state for empty space; will be replaced with VoidAgar later
+    int8_t VoidState = 0; // Default state for empty space; will be replaced with VoidAgar later
+    uint8_t Parity = 0; // Which of each chunk's two buffers holds the current generation
+    int ThreadCount = 0; // Threads used to step chunks; 0 = all hardware threads, 1 = serial
+    int ActiveChunks = 0; // Chunks actually stepped last generation; the rest were still or period 2
+
+    // Stepping can only be skipped while the rule and the void match what they were two generations ago
+    const R2INTRules* LastRule = nullptr;
+    uint64_t LastRuleVersion = 0;
+    int8_t PreviousVoidStates[2] = { 0, 0 }; // One and two generations ago
+
+    // Outer-totalistic rules step through a bit-sliced neighbor counter instead of the table,
+    // and rules that fit in a diamond or octagon through a compacted table; both are redone when the rule changes
+    TotalisticRule Totalistic;
+    std::shared_ptr<const ShapedRule> Shaped; // Shared by copies; null for full-square rules
+    const R2INTRules* AnalyzedRule = nullptr;
+    uint64_t AnalyzedRuleVersion = 0;
+
+    int Engine = ENGINE_CHUNKS;
+    int HashLifeStep = 0;
+    std::shared_ptr<HashLifeUniverse> hashLife; // Only caches results; contents stays the real state, so copies can share it
     
     World();
 
-    void Simulate(const R2INTRules& Rules);
+    void Simulate(const R2INTRules& Rules); // One jump when HashLife can take it, otherwise one generation
+    void StepChunks(const R2INTRules& Rules);
+    bool CanJump(const R2INTRules& Rules) const; // HashLife needs an empty void and a rule it supports
+    bool Jump(const R2INTRules& Rules, int exponent); // Advances 2^exponent generations; false, doing nothing, when it can't jump
     void PaintAtCell(sf::Vector2i p, int newState);
-    void LinkAllNeighbors();
 
     void TestRandomize();
 
     Chunk* GetNeighborGrid(int x, int y);
-    __int8 GetCellStateAt(sf::Vector2i p) const; // Uses Grid
-    __int8 GetCellStateAtOld(sf::Vector2i p) const; // Uses OldGrid
+    int8_t GetCellStateAt(sf::Vector2i p) const; // Uses the current buffer
 
     void EnsureAllPotentialNeighborGridsExist();
 
-    void Draw(sf::RenderWindow& window, const std::vector<sf::Color>& colors);
 
     sf::Vector2i GetWorldCoords(const sf::Vector2f& screenPos) const;
 
-    // GetRect function; returns global coordinates
+    // Bounding box of the live cells in global coordinates, and their count
+    // Both only read the summaries chunks keep as they step, so they cost O(chunks)
     sf::IntRect GetRect() const;
+    int64_t Population() const;
     void PrintRLE() const;
+    std::string ToRLE() const; // Header line plus the pattern
+    bool LoadRLE(const std::string& path); // Replaces the pattern; two-state RLE, header and # lines are skipped
 
     std::mt19937 rng;
 };
 
-void DeleteEmptyGrids(std::unordered_map<GridCoord, Chunk>& worldMap, __int8 VoidState);
+void DeleteEmptyGrids(ChunkMap& worldMap, int8_t VoidState);
 void EnsureNeighborsExist(World& world, Chunk& grid);
\ No newline at end of file